@@ -12,26 +12,28 @@
 #include "display.h"
 #include "world.h"
 #include "background.h"
+#include "layers.h"
 
 const Vec world_size = Vec{100, 100.0f * SCREEN_HEIGHT / SCREEN_WIDTH};
 World world(world_size);
 bool started = false;
 
 StarrySky background;
+display::LayeredRenderer layers;
+display::CommandBuffer &world_layer = layers[display::LayeredRenderer::World];
+display::CommandBuffer &hud = layers[display::LayeredRenderer::Hud];
 
 Vec world2screen(Vec v) {
-  Vec screen_size{SCREEN_WIDTH, SCREEN_HEIGHT};
-  v.y = world.size.y - v.y;
-  return v / world.size * screen_size;
+  return world.toScreen(v);
 }
 
 float world2screen(float x) {
-  Vec screen_size{SCREEN_WIDTH, SCREEN_HEIGHT};
-  return x / world.size.x * screen_size.x;
+  return world.toScreen(x);
 }
 
 void initialize()
 {
+  layers.dynamic_resolution = true;
 }
 
 Input handleControls() {
@@ -64,18 +66,10 @@ void act(float dt)
     world = World(world_size);
   }
 
-  world.step(dt, handleControls());
+  world.advance(dt, handleControls());
 }
 
 void drawPlayer(const Player &player) {
-  struct Seg{Vec a, b;} lines[] = {
-    {{ 1,  0}, {-1,  1}},
-    {{ 1,  0}, {-1, -1}},
-    {{-1, -1}, {-1,  1}}
-  };
-
-  Vec screen_size{SCREEN_WIDTH, SCREEN_HEIGHT};
-
   display::Color c{255, 200, 200};
   if (player.invincible) { // Flickering during respawn invincibility
     if ((int)(world.time / 0.1) % 2 == 0)
@@ -84,16 +78,18 @@ void drawPlayer(const Player &player) {
       c = display::Color{0, 255, 255};
   }
 
-  for (auto seg : lines) {
-    display::line(c, world2screen(player.body.trans.apply(seg.a)), world2screen(player.body.trans.apply(seg.b)));
-  }
+  const ConvexHull &hull = Player::hull;
+  Vec outline[ConvexHull::max_vertices];
+  for (int i = 0; i < hull.n; i++)
+    outline[i] = world2screen(player.body.trans.apply(hull.v[i]));
+  world_layer.polyline(c, outline, hull.n, true);
 }
 
 void drawProjectile(const Projectile &proj) {
-  display::circle(display::Color{30, 255, 255}, world2screen(proj.body.trans.pos), world2screen(Projectile::radius));
+  world_layer.circle(display::Color{30, 255, 255}, world2screen(proj.body.trans.pos), world2screen(Projectile::radius));
 }
 
-void drawAsteroid(const Asteroid &ast) {\
+void drawAsteroid(const Asteroid &ast) {
   Vec p = world2screen(ast.body.trans.pos);
   float r = world2screen(ast.radius);
 
@@ -101,17 +97,24 @@ void drawAsteroid(const Asteroid &ast) {\
   int y0 = p.y - r;
   int w = r * 2;
   int h = w;
-  display::sprite(x0, y0, w, h, display::sprites::asteroids[ast.color]);
+  world_layer.sprite(x0, y0, w, h, display::sprites::asteroids[ast.color], world.asteroid_filter,
+                     ast.body.trans.rot);
 }
 
 void draw()
 {
-  std::fill(&buffer[0][0], &buffer[0][0] + SCREEN_WIDTH * SCREEN_HEIGHT, 0);
+  layers.clear();
 
-  background.draw();
+  background.draw(layers[display::LayeredRenderer::Background]);
 
+  // Oldest first, like they came in, whatever World::reorder did
+  static std::vector<const Asteroid *> by_age;
+  by_age.clear();
   for (auto &asteroid : world.asteroids)
-    drawAsteroid(asteroid);
+    by_age.push_back(&asteroid);
+  std::sort(by_age.begin(), by_age.end(), [](const Asteroid *a, const Asteroid *b) { return a->id < b->id; });
+  for (const Asteroid *asteroid : by_age)
+    drawAsteroid(*asteroid);
   for (auto &proj : world.projectiles)
     drawProjectile(proj);
 
@@ -119,7 +122,7 @@ void draw()
     drawPlayer(world.player);
   
   for (int i = 0; i < world.player.lives; i++) {
-    display::sprite(50 + i * 100, 50, 80, 80, display::sprites::hearth);
+    hud.sprite(50 + i * 100, 50, 80, 80, display::sprites::hearth);
   }
 
   {
@@ -127,23 +130,25 @@ void draw()
     std::snprintf(score_str, 6, "%+05d", world.player.score);
     if (world.player.score >= 0)
       score_str[0] = ' '; // remove minus sign, i don't know printf specifiers
-    display::text(SCREEN_WIDTH, display::sprites::font_size, "Score: " + std::string(score_str) + " ", display::TextAlign::RIGHT);
+    hud.text(SCREEN_WIDTH, display::sprites::font_size, "Score: " + std::string(score_str) + " ", display::TextAlign::RIGHT);
   }
 
   if (world.player.lives == 0) {
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Your ship has crashed!", display::TextAlign::CENTER);
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to restart!", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Your ship has crashed!", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to restart!", display::TextAlign::CENTER);
   }
 
   if (world.asteroids.size() == 0) {
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Level cleared!", display::TextAlign::CENTER);
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to restart!", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Level cleared!", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to restart!", display::TextAlign::CENTER);
   }
 
   if (!started) {
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Arrows - move, space - shoot", display::TextAlign::CENTER);
-    display::text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to start!", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 - 20, "Arrows - move, space - shoot", display::TextAlign::CENTER);
+    hud.text(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 + 20, "Press ENTER to start!", display::TextAlign::CENTER);
   }
+
+  layers.render();
 }
 
 void finalize()
@@ -4,6 +4,7 @@
 
 #include "geometry.h"
 #include "display.h"
+#include "commands.h"
 
 // Just for 
 struct StarrySky {
@@ -42,17 +43,17 @@ struct StarrySky {
       stars.push_back(makeStar());
   }
 
-  void drawStar(const Star &star) {
+  void drawStar(display::CommandBuffer &cmds, const Star &star) {
     float alive_frac = (time - star.spawn_time) / star.duration;
     float intensity = 1 - std::abs(alive_frac - 0.5) * 2;
     float real_sz = star.size * intensity;
-    display::Color color{100, 100, 100};
-    display::line(color, star.pos + Vec{-1,  0} * real_sz, star.pos + Vec{+1,  0} * real_sz);
-    display::line(color, star.pos + Vec{ 0, -1} * real_sz, star.pos + Vec{ 0, +1} * real_sz);
+    display::Color color = display::fade({100, 100, 100}, std::max(intensity, 0.0f) * 255);
+    cmds.line(color, star.pos + Vec{-1,  0} * real_sz, star.pos + Vec{+1,  0} * real_sz);
+    cmds.line(color, star.pos + Vec{ 0, -1} * real_sz, star.pos + Vec{ 0, +1} * real_sz);
   }
 
-  void draw() {
+  void draw(display::CommandBuffer &cmds) {
     for (const Star &star : stars)
-      drawStar(star);
+      drawStar(cmds, star);
   }
 };
\ No newline at end of file
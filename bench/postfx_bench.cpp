@@ -0,0 +1,55 @@
+// Milliseconds per frame of post-processing at 1024x768 and 4K, on a frame
+// with a few bright spots like projectiles over a dark background
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "postfx.h"
+#include "tiles.h"
+
+uint32_t buffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+using namespace display;
+
+namespace {
+  void fillFrame(PostProcess &post, int w, int h) {
+    std::mt19937 rng(1);
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++) {
+      bool bright = rng() % 200 == 0;
+      post.frameRow(y)[x] = bright ? 0xffffffff : 0xff000000 | (rng() & 0x3f3f3f);
+    }
+  }
+
+  double msPerFrame(PostProcess &post, const Surface &out) {
+    constexpr int warmup = 5, frames = 100;
+    for (int i = 0; i < warmup; i++)
+      post.apply(out);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+      post.apply(out);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+  }
+}
+
+int main() {
+  printf("%d threads\n", workers().threads());
+  const int sizes[][2] = {{1024, 768}, {3840, 2160}};
+  for (const auto &size : sizes) {
+    int w = size[0], h = size[1];
+    PostProcess post(w, h);
+    std::vector<uint32_t> pixels(w * h);
+    Surface out = Surface::of(pixels.data(), w, h, w);
+    fillFrame(post, w, h);
+
+    const struct { const char *name; bool bloom, crt; } modes[] = {
+      {"bloom", true, false}, {"crt", false, true}, {"bloom+crt", true, true},
+    };
+    for (const auto &mode : modes) {
+      post.bloom = mode.bloom, post.crt = mode.crt;
+      printf("%dx%d %-10s %6.3f ms/frame\n", w, h, mode.name, msPerFrame(post, out));
+    }
+  }
+}
@@ -0,0 +1,132 @@
+// Time and cache misses of World::step with thousands of asteroids and
+// projectiles, for a few Z-order re-sort intervals (World::reorder_interval)
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "world.h"
+
+uint32_t buffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+namespace {
+  // Last level cache misses of this thread, -1 where the kernel has no
+  // hardware counters (VMs, containers)
+  struct CacheMisses {
+    int fd;
+
+    CacheMisses() {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.size = sizeof attr;
+      attr.config = PERF_COUNT_HW_CACHE_MISSES;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    ~CacheMisses() { if (fd >= 0) close(fd); }
+
+    void start() {
+      if (fd < 0) return;
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    long long stop() {
+      if (fd < 0) return -1;
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      long long count = 0;
+      return read(fd, &count, sizeof count) == sizeof count ? count : -1;
+    }
+  };
+
+  // Asteroids and projectiles that were hit come back at random places, so
+  // the counts stay put and memory order drifts away from world order like
+  // it does in the game
+  void refill(World &world, int asteroids, int projectiles) {
+    while ((int)world.asteroids.size() < asteroids)
+      world.spawnRandomAsteroid();
+    while ((int)world.projectiles.size() < projectiles) {
+      Vec pos{World::frand() * world.size.x, World::frand() * world.size.y};
+      Vec vel = Vec{Projectile::speed, 0}.rotate(World::frand() * 2 * pi);
+      world.projectiles.push_back(Projectile{world.makeBody({pos, 0}, vel), world.time});
+    }
+  }
+
+  // The game's density of asteroids, on a world scaled up to fit them
+  World makeWorld(int asteroids, int projectiles) {
+    srand(1);
+    float scale = std::sqrt(asteroids / 10.0f);
+    World world(Vec{100 * scale, 100.0f * SCREEN_HEIGHT / SCREEN_WIDTH * scale});
+    refill(world, asteroids, projectiles);
+    return world;
+  }
+
+  struct Result {
+    double ms = 0;
+    long long misses = 0; // -1 if not counted
+  };
+
+  // Steps with the counts kept up, the first `warmup` steps fill the sprite
+  // and mask caches and are not measured
+  Result run(int asteroids, int projectiles, int reorder_interval, CacheMisses &misses) {
+    constexpr int warmup = 50, steps = 300;
+    World world = makeWorld(asteroids, projectiles);
+    world.reorder_interval = reorder_interval;
+    world.player.invincible = true;
+
+    Result res;
+    for (int i = -warmup; i < steps; i++) {
+      // Projectiles never expire, the player never gets hit
+      for (Projectile &proj : world.projectiles)
+        proj.spawn_time = world.time;
+      world.player.invincible_start = world.time;
+      refill(world, asteroids, projectiles);
+
+      misses.start();
+      auto start = std::chrono::steady_clock::now();
+      world.step(World::fixed_point ? World::tick : 1.0f / 60, Input{});
+      auto end = std::chrono::steady_clock::now();
+      long long m = misses.stop();
+      if (i < 0) continue;
+      res.ms += std::chrono::duration<double, std::milli>(end - start).count() / steps;
+      res.misses = m < 0 || res.misses < 0 ? -1 : res.misses + m / steps;
+    }
+    return res;
+  }
+}
+
+int main() {
+  // Intervals take turns over a few rounds so drifting clocks and a warm
+  // first run favour none of them
+  constexpr int rounds = 3;
+  const int counts[][2] = {{30, 30}, {100, 100}, {1000, 1000}, {4000, 4000}, {16000, 16000}};
+  const int intervals[] = {0, 1, 4, 8, 16, 32, 64};
+  constexpr int n = sizeof intervals / sizeof intervals[0];
+  CacheMisses misses;
+
+  for (const auto &count : counts) {
+    Result total[n];
+    for (int round = 0; round < rounds; round++)
+    for (int k = 0; k < n; k++) {
+      Result r = run(count[0], count[1], intervals[k], misses);
+      total[k].ms += r.ms / rounds;
+      total[k].misses = r.misses < 0 || total[k].misses < 0 ? -1 : total[k].misses + r.misses / rounds;
+    }
+
+    for (int k = 0; k < n; k++) {
+      printf("%5d asteroids %5d projectiles, reorder every %2d: %7.3f ms/step",
+             count[0], count[1], intervals[k], total[k].ms);
+      if (total[k].misses >= 0)
+        printf(", %8lld cache misses/step", total[k].misses);
+      printf("\n");
+    }
+  }
+}
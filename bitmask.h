@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <cmath>
+
+#include "display.h"
+#include "collision.h"
+
+// 1-bit coverage image, rows packed into 64-bit words.
+// Bit b of word k in a row is column 64 * k + b.
+struct Bitmask {
+  int width = 0, height = 0;
+  int words = 0; // per row
+  std::vector<uint64_t> bits;
+  int ox = 0, oy = 0; // top-left pixel relative to the top-left of what it was made from
+
+  Bitmask() = default;
+  Bitmask(int w, int h): width(w), height(h), words((w + 63) / 64), bits(words * h, 0) {}
+
+  const uint64_t *row(int y) const { return &bits[y * words]; }
+
+  void set(int x, int y) { bits[y * words + x / 64] |= uint64_t(1) << (x % 64); }
+
+  bool test(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) return false;
+    return row(y)[x / 64] >> (x % 64) & 1;
+  }
+
+  // 64 columns of row y starting at column x, zeros outside the mask
+  uint64_t extract(int y, int x) const {
+    const uint64_t *r = row(y);
+    auto word = [&](int k) { return 0 <= k && k < words ? r[k] : 0; };
+    int k = x >> 6, s = x & 63; // floor division, works for negative x too
+    if (s == 0) return word(k);
+    return word(k) >> s | word(k + 1) << (64 - s);
+  }
+
+  template <class Pred>
+  static Bitmask fromPredicate(int w, int h, Pred &&inside) {
+    Bitmask m(w, h);
+    for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+      if (inside(x, y)) m.set(x, y);
+    return m;
+  }
+
+  // Visible pixels of the sprite drawn with display::sprite at w x h, turned
+  // by angle_step (see display::angleStep)
+  static Bitmask fromSprite(const display::Sprite &sprite, int w, int h,
+                            display::Filter filter = display::Filter::Nearest, int angle_step = 0) {
+    display::Sprite scaled = display::scale(sprite, w, h, filter);
+    if (angle_step)
+      scaled = display::turn(scaled, angle_step);
+    Bitmask m = fromPredicate(scaled.width(), scaled.height(), [&](int x, int y) {
+      return scaled.row(y)[x].a != 0;
+    });
+    if (angle_step) {
+      display::Rect b = display::AffineMap::rotated(0, 0, w, h, angle_step).bounds;
+      m.ox = b.x0, m.oy = b.y0;
+    }
+    return m;
+  }
+
+  // Pixels within half a pixel of the hull, given in mask pixel coordinates
+  static Bitmask fromHull(const ConvexHull &hull, int w, int h) {
+    return fromPredicate(w, h, [&](int x, int y) {
+      return collision::overlap(hull, Vec{(float)x, (float)y}, 0.5f);
+    });
+  }
+
+  // Cached mask for a sprite scaled to w x h and turned
+  static const Bitmask &ofSprite(const display::Sprite &sprite, int w, int h,
+                                 display::Filter filter = display::Filter::Nearest, int angle_step = 0) {
+    static std::map<std::tuple<const display::Sprite *, int, int, display::Filter, int>, Bitmask> cache;
+    auto key = std::make_tuple(&sprite, w, h, filter, angle_step);
+    auto it = cache.find(key);
+    if (it == cache.end())
+      it = cache.emplace(key, fromSprite(sprite, w, h, filter, angle_step)).first;
+    return it->second;
+  }
+
+  // Do masks a and b overlap when their top-left corners are at (ax, ay) and
+  // (bx, by)? Costs one shifted AND per 64 columns of every shared row.
+  static bool overlap(const Bitmask &a, int ax, int ay, const Bitmask &b, int bx, int by) {
+    int y0 = std::max(ay, by), y1 = std::min(ay + a.height, by + b.height);
+    int x0 = std::max(ax, bx), x1 = std::min(ax + a.width, bx + b.width);
+    if (y0 >= y1 || x0 >= x1) return false;
+
+    int k0 = (x0 - ax) / 64, k1 = (x1 - ax - 1) / 64;
+    for (int y = y0; y < y1; y++) {
+      const uint64_t *ra = a.row(y - ay);
+      for (int k = k0; k <= k1; k++)
+        if (ra[k] & b.extract(y - by, ax + k * 64 - bx))
+          return true;
+    }
+    return false;
+  }
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <vector>
+
+#include "geometry.h"
+
+inline float dot(Vec a, Vec b) { return a.x * b.x + a.y * b.y; }
+inline float cross(Vec a, Vec b) { return a.x * b.y - a.y * b.x; }
+
+// Small convex polygon, vertices counter-clockwise around the local origin
+struct ConvexHull {
+  static constexpr int max_vertices = 12;
+
+  std::array<Vec, max_vertices> v;
+  int n = 0;
+
+  // Convex hull of the points (monotone chain)
+  static ConvexHull of(const Vec *pts, int count) {
+    assert(0 < count && count <= max_vertices);
+    std::array<Vec, max_vertices> p{};
+    std::copy(pts, pts + count, p.begin());
+    std::array<Vec, 2 * max_vertices> h{};
+    int k = chain(p.data(), count, h.data());
+
+    ConvexHull hull;
+    hull.n = k;
+    std::copy(h.begin(), h.begin() + k, hull.v.begin());
+    return hull;
+  }
+
+  // Convex hull of any number of points, cut down to max_vertices by
+  // dropping the vertices that hold the least area. What is left lies
+  // inside the full hull.
+  static ConvexHull fit(std::vector<Vec> pts) {
+    assert(!pts.empty());
+    std::vector<Vec> h(2 * pts.size());
+    h.resize(chain(pts.data(), pts.size(), h.data()));
+    while ((int)h.size() > max_vertices) {
+      int drop = 0;
+      float least = INFINITY;
+      for (int i = 0; i < (int)h.size(); i++) {
+        Vec prev = h[(i + h.size() - 1) % h.size()], next = h[(i + 1) % h.size()];
+        float area = cross(h[i] - prev, next - prev);
+        if (area < least) least = area, drop = i;
+      }
+      h.erase(h.begin() + drop);
+    }
+
+    ConvexHull hull;
+    hull.n = h.size();
+    std::copy(h.begin(), h.end(), hull.v.begin());
+    return hull;
+  }
+
+  float boundingRadius() const {
+    float r = 0;
+    for (int i = 0; i < n; i++)
+      r = std::max(r, v[i].len());
+    return r;
+  }
+
+  ConvexHull scaled(float k) const {
+    ConvexHull res = *this;
+    for (int i = 0; i < n; i++)
+      res.v[i] = v[i] * k;
+    return res;
+  }
+
+  // Rotated by `rot` around the local origin, then moved to `pos`
+  ConvexHull transformed(Vec pos, float rot) const {
+    ConvexHull res;
+    res.n = n;
+    float c = std::cos(rot), s = std::sin(rot);
+    for (int i = 0; i < n; i++)
+      res.v[i] = pos + Vec{c * v[i].x - s * v[i].y, s * v[i].x + c * v[i].y};
+    return res;
+  }
+
+private:
+  // Monotone chain, sorts p and writes the hull to h, which needs room for
+  // 2 * count points. Returns the number of hull vertices, at least 1.
+  static int chain(Vec *p, int count, Vec *h) {
+    std::sort(p, p + count, [](Vec a, Vec b) {
+      return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    int k = 0;
+    for (int i = 0; i < count; i++) {
+      while (k >= 2 && cross(h[k - 1] - h[k - 2], p[i] - h[k - 2]) <= 0) k--;
+      h[k++] = p[i];
+    }
+    for (int i = count - 2, lower = k + 1; i >= 0; i--) {
+      while (k >= lower && cross(h[k - 1] - h[k - 2], p[i] - h[k - 2]) <= 0) k--;
+      h[k++] = p[i];
+    }
+    return std::max(k - 1, 1);
+  }
+};
+
+namespace collision {
+  // Projects the hull onto the axis
+  inline void project(const ConvexHull &h, Vec axis, float &lo, float &hi) {
+    lo = hi = dot(h.v[0], axis);
+    for (int i = 1; i < h.n; i++) {
+      float d = dot(h.v[i], axis);
+      lo = std::min(lo, d), hi = std::max(hi, d);
+    }
+  }
+
+  // True if any edge normal of `a` separates the hulls
+  inline bool hasSeparatingAxis(const ConvexHull &a, const ConvexHull &b) {
+    for (int i = 0; i < a.n; i++) {
+      Vec e = a.v[(i + 1) % a.n] - a.v[i];
+      Vec axis{e.y, -e.x};
+      float alo, ahi, blo, bhi;
+      project(a, axis, alo, ahi);
+      project(b, axis, blo, bhi);
+      if (ahi < blo || bhi < alo)
+        return true;
+    }
+    return false;
+  }
+
+  // Separating axis test, both hulls already in the same frame
+  inline bool overlap(const ConvexHull &a, const ConvexHull &b) {
+    return !hasSeparatingAxis(a, b) && !hasSeparatingAxis(b, a);
+  }
+
+  inline bool overlap(const ConvexHull &h, Vec c, float r) {
+    // Inside, or close enough to some edge
+    bool inside = true;
+    for (int i = 0; i < h.n; i++) {
+      Vec a = h.v[i], b = h.v[(i + 1) % h.n];
+      Vec e = b - a;
+      if (cross(e, c - a) < 0) inside = false;
+      float t = std::clamp(dot(c - a, e) / dot(e, e), 0.0f, 1.0f);
+      Vec d = c - (a + e * t);
+      if (dot(d, d) <= r * r) return true;
+    }
+    return inside;
+  }
+}
@@ -0,0 +1,173 @@
+#include "commands.h"
+
+namespace display {
+
+void CommandBuffer::rect(Color color, int x0, int y0, int w, int h) {
+  Command cmd{Command::Type::Rect, color, Rect{x0, y0, x0 + w, y0 + h}, {}};
+  cmd.rect = cmd.bounds;
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::line(Color color, Vec a, Vec b) {
+  Vec ends[] = {a, b};
+  Command cmd{Command::Type::Line, color, boundsOf(ends, 2), {}};
+  cmd.line = {a, b};
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::polyline(Color color, const Vec *pts, int n, bool closed) {
+  if (n <= 0) return;
+  Command cmd{Command::Type::Polyline, color, boundsOf(pts, n), {}};
+  cmd.polyline = {(uint32_t)points.size(), (uint32_t)n, closed};
+  points.insert(points.end(), pts, pts + n);
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::circle(Color color, Vec p, float r) {
+  int pad = std::ceil(r) + 1;
+  Rect b = boundsOf(&p, 1);
+  Command cmd{Command::Type::Circle, color, Rect{b.x0 - pad, b.y0 - pad, b.x1 + pad, b.y1 + pad}, {}};
+  cmd.circle = {p, r};
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::sprite(int x0, int y0, int w, int h, const Sprite &sprite, Filter filter, float angle) {
+  int step = angleStep(angle);
+  Rect bounds = step ? AffineMap::rotated(x0, y0, w, h, step).bounds : Rect{x0, y0, x0 + w, y0 + h};
+  Command cmd{Command::Type::Sprite, Color{}, bounds, {}};
+  cmd.sprite = {x0, y0, w, h, &sprite, filter, angle};
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::text(int x0, int y0, std::string_view s, TextAlign align, Color color) {
+  Command cmd{Command::Type::Text, color, textBounds(x0, y0, s, align), {}};
+  cmd.text = {x0, y0, (uint32_t)chars.size(), (uint32_t)s.size(), align};
+  chars.insert(chars.end(), s.begin(), s.end());
+  cmds.push_back(cmd);
+}
+
+void CommandBuffer::scaled(float k, CommandBuffer &out) const {
+  out.clear();
+  auto at = [&](int x) { return (int)std::round(x * k); };
+  for (const Command &cmd : cmds) {
+    switch (cmd.type) {
+      case Command::Type::Rect: {
+        const Rect &r = cmd.rect;
+        out.rect(cmd.color, at(r.x0), at(r.y0), at(r.x1) - at(r.x0), at(r.y1) - at(r.y0));
+        break;
+      }
+      case Command::Type::Line:
+        out.line(cmd.color, cmd.line.a * k, cmd.line.b * k);
+        break;
+      case Command::Type::Polyline: {
+        Command c = cmd;
+        c.polyline.first = out.points.size();
+        for (uint32_t i = 0; i < cmd.polyline.count; i++)
+          out.points.push_back(points[cmd.polyline.first + i] * k);
+        c.bounds = boundsOf(&out.points[c.polyline.first], c.polyline.count);
+        out.cmds.push_back(c);
+        break;
+      }
+      case Command::Type::Circle:
+        out.circle(cmd.color, cmd.circle.p * k, cmd.circle.r * k);
+        break;
+      case Command::Type::Sprite: {
+        // Sizes scaled on their own, so they do not jitter with the position
+        const Command::SpriteData &s = cmd.sprite;
+        out.sprite(at(s.x0), at(s.y0), at(s.w), at(s.h), *s.sprite, s.filter, s.angle);
+        break;
+      }
+      case Command::Type::Text: {
+        const Command::TextData &t = cmd.text;
+        out.text(at(t.x0), at(t.y0), std::string_view(chars.data() + t.first, t.length), t.align, cmd.color);
+        break;
+      }
+    }
+  }
+}
+
+namespace {
+  struct Hasher {
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    template <class T>
+    Hasher &add(const T &x) {
+      const unsigned char *p = reinterpret_cast<const unsigned char *>(&x);
+      for (size_t i = 0; i < sizeof(T); i++)
+        h = (h ^ p[i]) * 0x100000001b3ull;
+      return *this;
+    }
+
+    Hasher &add(Vec v) { return add(v.x).add(v.y); }
+    Hasher &add(Rect r) { return add(r.x0).add(r.y0).add(r.x1).add(r.y1); }
+    Hasher &add(Color c) { return add(reinterpret_cast<const uint32_t &>(c)); }
+  };
+}
+
+uint64_t CommandBuffer::hash(const Command &cmd) const {
+  Hasher h;
+  h.add(cmd.type).add(cmd.color).add(cmd.bounds);
+  switch (cmd.type) {
+    case Command::Type::Rect:
+      h.add(cmd.rect);
+      break;
+    case Command::Type::Line:
+      h.add(cmd.line.a).add(cmd.line.b);
+      break;
+    case Command::Type::Polyline:
+      h.add(cmd.polyline.closed);
+      for (uint32_t i = 0; i < cmd.polyline.count; i++)
+        h.add(points[cmd.polyline.first + i]);
+      break;
+    case Command::Type::Circle:
+      h.add(cmd.circle.p).add(cmd.circle.r);
+      break;
+    case Command::Type::Sprite:
+      h.add(cmd.sprite.x0).add(cmd.sprite.y0).add(cmd.sprite.w).add(cmd.sprite.h);
+      h.add(cmd.sprite.sprite).add(cmd.sprite.filter).add(angleStep(cmd.sprite.angle));
+      break;
+    case Command::Type::Text:
+      h.add(cmd.text.x0).add(cmd.text.y0).add(cmd.text.align);
+      for (uint32_t i = 0; i < cmd.text.length; i++)
+        h.add(chars[cmd.text.first + i]);
+      break;
+  }
+  return h.h;
+}
+
+void CommandBuffer::clear() {
+  cmds.clear();
+  points.clear();
+  chars.clear();
+}
+
+void CommandBuffer::execute(const Command &cmd, const Surface &s) const {
+  switch (cmd.type) {
+    case Command::Type::Rect:
+      display::rect(s, cmd.color, cmd.rect.x0, cmd.rect.y0, cmd.rect.x1 - cmd.rect.x0, cmd.rect.y1 - cmd.rect.y0);
+      break;
+    case Command::Type::Line:
+      display::line(s, cmd.color, cmd.line.a, cmd.line.b);
+      break;
+    case Command::Type::Polyline:
+      display::polyline(s, cmd.color, points.data() + cmd.polyline.first, cmd.polyline.count, cmd.polyline.closed);
+      break;
+    case Command::Type::Circle:
+      display::circle(s, cmd.color, cmd.circle.p, cmd.circle.r);
+      break;
+    case Command::Type::Sprite:
+      display::sprite(s, cmd.sprite.x0, cmd.sprite.y0, cmd.sprite.w, cmd.sprite.h, *cmd.sprite.sprite, cmd.sprite.filter, cmd.sprite.angle);
+      break;
+    case Command::Type::Text:
+      display::text(s, cmd.text.x0, cmd.text.y0, std::string_view(chars.data() + cmd.text.first, cmd.text.length), cmd.text.align,
+                    cmd.color);
+      break;
+  }
+}
+
+void CommandBuffer::execute(const Surface &s) const {
+  for (const Command &cmd : cmds)
+    execute(cmd, s);
+}
+
+}
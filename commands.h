@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "display.h"
+
+namespace display {
+  // One recorded draw call. Plain data, variable sized parts like polyline
+  // points and text live in the arrays of the owning CommandBuffer.
+  struct Command {
+    enum class Type : uint8_t { Rect, Line, Polyline, Circle, Sprite, Text };
+
+    Type type;
+    Color color;
+    Rect bounds; // every pixel it may touch
+
+    struct PolylineData { uint32_t first, count; bool closed; };
+    struct SpriteData { int x0, y0, w, h; const display::Sprite *sprite; Filter filter; float angle; };
+    struct TextData { int x0, y0; uint32_t first, length; TextAlign align; };
+
+    union {
+      Rect rect;
+      struct { Vec a, b; } line;
+      PolylineData polyline;
+      struct { Vec p; float r; } circle;
+      SpriteData sprite;
+      TextData text;
+    };
+
+    // Blends with what is behind it somewhere
+    bool translucent() const {
+      switch (type) {
+        case Type::Sprite: return sprite.sprite->translucent;
+        default: return color.a != 255;
+      }
+    }
+  };
+
+  // Draw calls of one frame, recorded by game code and executed later by a
+  // renderer. Clearing keeps the memory, so steady state recording does not
+  // allocate.
+  class CommandBuffer {
+  public:
+    void rect(Color color, int x0, int y0, int w, int h);
+    void line(Color color, Vec a, Vec b);
+    void polyline(Color color, const Vec *pts, int n, bool closed = false);
+    void circle(Color color, Vec p, float r);
+    void sprite(int x0, int y0, int w, int h, const Sprite &sprite, Filter filter = Filter::Nearest, float angle = 0);
+    void text(int x0, int y0, std::string_view s, TextAlign align = TextAlign::LEFT, Color color = colors::white);
+
+    void clear();
+
+    // The same commands for a surface k times the size of the screen, into
+    // out. Lines stay a pixel wide and text keeps its glyph size.
+    void scaled(float k, CommandBuffer &out) const;
+
+    const std::vector<Command> &commands() const { return cmds; }
+
+    // Equal for commands that draw the same pixels
+    uint64_t hash(const Command &cmd) const;
+
+    // Draws one command, cut to the surface's clip
+    void execute(const Command &cmd, const Surface &s = screen()) const;
+
+    // Draws everything in order
+    void execute(const Surface &s = screen()) const;
+
+  private:
+    std::vector<Command> cmds;
+    std::vector<Vec> points;
+    std::vector<char> chars;
+  };
+}
@@ -1,37 +1,505 @@
 #include "display.h"
 #include <string>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+#include <iterator>
+#include <initializer_list>
 
 namespace display {
 
-Sprite Sprite::fromString(std::string s, std::vector<Color> pallete) {
-  Color bg{0, 0, 0, 1};
+const std::vector<int> &cachedCircleSpans(int t) {
+  assert(0 <= t && t <= circle_cache_max);
+  static const std::vector<std::vector<int>> tables = [] {
+    std::vector<std::vector<int>> res;
+    for (int i = 0; i <= circle_cache_max; i++)
+      res.push_back(circleSpans(i));
+    return res;
+  }();
+  return tables[t];
+}
+
+namespace {
+  // Calls emit(start, len) for every run of pixels that are not transparent
+  template <class Emit>
+  constexpr void forSpans(const Color *row, int w, Emit &&emit) {
+    for (int x = 0; x < w; x++) {
+      if (row[x].a == 0) continue;
+      int start = x;
+      while (x < w && row[x].a != 0) x++;
+      emit(start, x - start);
+    }
+  }
+
+  constexpr bool anyTranslucent(const Color *pixels, int n) {
+    for (int i = 0; i < n; i++)
+      if (pixels[i].a != 0 && pixels[i].a != 255)
+        return true;
+    return false;
+  }
+
+  // Setting up a span costs about as much as masking this many pixels
+  constexpr bool preferMask(int spans, int w, int h) {
+    constexpr int span_cost = 32;
+    return spans * span_cost > w * h;
+  }
+
+  // Half size, (w + 1) / 2 x (h + 1) / 2. Without translucent pixels a pixel
+  // is opaque if at least two of its four sources are and gets their average
+  // color, otherwise all four are averaged.
+  constexpr void downsample(const Color *src, int w, int h, bool translucent, Color *dst) {
+    int dw = (w + 1) / 2, dh = (h + 1) / 2;
+    for (int y = 0; y < dh; y++)
+    for (int x = 0; x < dw; x++) {
+      // Odd edges reuse the last row or column
+      int xs[2] = {2 * x, std::min(2 * x + 1, w - 1)};
+      int ys[2] = {2 * y, std::min(2 * y + 1, h - 1)};
+      int b = 0, g = 0, r = 0, a = 0, n = 0;
+      for (int sy : ys)
+      for (int sx : xs) {
+        Color c = src[sy * w + sx];
+        if (!translucent && c.a == 0) continue;
+        b += c.b, g += c.g, r += c.r, a += c.a, n++;
+      }
+      Color &res = dst[y * dw + x];
+      if (translucent)
+        res = Color{uint8_t((b + 2) / 4), uint8_t((g + 2) / 4), uint8_t((r + 2) / 4), uint8_t((a + 2) / 4)};
+      else if (n >= 2)
+        res = Color{uint8_t((b + n / 2) / n), uint8_t((g + n / 2) / n), uint8_t((r + n / 2) / n)};
+      else
+        res = Color{0, 0, 0, 0};
+    }
+  }
+}
+
+struct Sprite::Storage {
+  std::vector<Color> pixels;
+  std::vector<Span> spans;
+  std::vector<int> row_spans;
+  std::vector<uint8_t> indices;
+};
+
+Sprite Sprite::fromPixels(int w, int h, std::vector<Color> pixels, std::vector<uint8_t> indices) {
+  auto storage = std::make_shared<Storage>();
+  storage->pixels = std::move(pixels);
+  storage->indices = std::move(indices);
+  std::vector<Span> &spans = storage->spans;
+  std::vector<int> &row_spans = storage->row_spans;
+  row_spans.reserve(h + 1);
+  for (int y = 0; y < h; y++) {
+    row_spans.push_back(spans.size());
+    forSpans(&storage->pixels[y * w], w, [&](int start, int len) { spans.push_back(Span{start, len}); });
+  }
+  row_spans.push_back(spans.size());
+
+  Sprite res;
+  res.w = w, res.h = h;
+  res.pixels = storage->pixels.data();
+  res.spans = spans.data();
+  res.row_spans = row_spans.data();
+  res.masked = preferMask(spans.size(), w, h);
+  res.translucent = anyTranslucent(res.pixels, w * h);
+  res.half = nullptr;
+  res.indices = storage->indices.empty() ? nullptr : storage->indices.data();
+  res.storage = std::move(storage);
+  return res;
+}
+
+namespace {
+  Sprite scaleNearest(const Sprite &sprite, int w, int h) {
+    std::vector<Color> pixels(w * h);
+    std::vector<uint8_t> indices;
+
+    std::vector<int> sxs(w);
+    for (int x = 0; x < w; x++)
+      sxs[x] = w > 1 ? std::round((float)x / (w - 1) * (sprite.width() - 1)) : 0;
+
+    for (int y = 0; y < h; y++) {
+      int sy = h > 1 ? std::round((float)y / (h - 1) * (sprite.height() - 1)) : 0;
+      const Color *src = sprite.row(sy);
+      Color *dst = &pixels[y * w];
+      for (int x = 0; x < w; x++)
+        dst[x] = src[sxs[x]];
+      if (sprite.indices) {
+        indices.resize(w * h);
+        for (int x = 0; x < w; x++)
+          indices[y * w + x] = sprite.indexRow(sy)[sxs[x]];
+      }
+    }
+    return Sprite::fromPixels(w, h, std::move(pixels), std::move(indices));
+  }
 
-  std::vector<std::vector<Color>> lines(1);
-  for (char c : s) {
-    if (c == '\n') {
-      if (!lines.back().empty())
-        lines.emplace_back();
-    } else if (c == '.')
-      lines.back().push_back(bg);
-    else if ('0' <= c && c <= '9')
-      lines.back().push_back(pallete.at(c - '0'));
-    else
-      assert(false);
+  // Filter weights have 7 bits, so weight times difference fits in 16 bits
+  constexpr int filter_bits = 7, filter_one = 1 << filter_bits;
+
+  // Destination pixel i sits between source pixels s0 and s1, f is the
+  // weight of s1
+  struct Tap { int s0, s1, f; };
+
+  std::vector<Tap> taps(int n, int sn) {
+    std::vector<Tap> res(n);
+    for (int i = 0; i < n; i++) {
+      int p = n > 1 ? std::lround((double)i * (sn - 1) * filter_one / (n - 1)) : 0;
+      int s0 = p >> filter_bits;
+      res[i] = Tap{s0, std::min(s0 + 1, sn - 1), p & (filter_one - 1)};
+    }
+    return res;
+  }
+
+  // a + (b - a) * f per channel, same rounding as the SSE2 path
+  uint32_t lerp(uint32_t a, uint32_t b, int f) {
+    uint32_t res = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      int ca = a >> shift & 0xff, cb = b >> shift & 0xff;
+      res |= uint32_t(ca + (((cb - ca) * f + filter_one / 2) >> filter_bits)) << shift;
+    }
+    return res;
+  }
+
+#ifdef __SSE2__
+  // Same as lerp for 4 pixels, f_lo and f_hi hold the weights of pixels 0, 1
+  // and 2, 3 in every channel
+  inline __m128i lerp4(__m128i a, __m128i b, __m128i f_lo, __m128i f_hi) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(filter_one / 2);
+    __m128i a_lo = _mm_unpacklo_epi8(a, zero), a_hi = _mm_unpackhi_epi8(a, zero);
+    __m128i d_lo = _mm_sub_epi16(_mm_unpacklo_epi8(b, zero), a_lo);
+    __m128i d_hi = _mm_sub_epi16(_mm_unpackhi_epi8(b, zero), a_hi);
+    d_lo = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d_lo, f_lo), half), filter_bits);
+    d_hi = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d_hi, f_hi), half), filter_bits);
+    return _mm_packus_epi16(_mm_add_epi16(a_lo, d_lo), _mm_add_epi16(a_hi, d_hi));
+  }
+#endif
+
+  // Premultiplied pixels interpolate as they are, transparent ones drop out
+  // of the weighted sums
+  Sprite scaleBilinear(const Sprite &sprite, int w, int h) {
+    int sw = sprite.width(), sh = sprite.height();
+    const uint32_t *src = reinterpret_cast<const uint32_t *>(sprite.row(0));
+
+    // 255 / a in 16.16 for the alphas that end up opaque
+    static const std::vector<uint32_t> unpremultiply = [] {
+      std::vector<uint32_t> res(256, 0);
+      for (int a = filter_one; a < 256; a++)
+        res[a] = ((255u << 16) + a / 2) / a;
+      return res;
+    }();
+
+    std::vector<Tap> xs = taps(w, sw), ys = taps(h, sh);
+    std::vector<uint32_t> column(sw), row(w);
+    std::vector<Color> pixels(w * h);
+    for (int y = 0; y < h; y++) {
+      // Vertical pass over whole source rows
+      const uint32_t *r0 = &src[ys[y].s0 * sw], *r1 = &src[ys[y].s1 * sw];
+      int fy = ys[y].f, x = 0;
+#ifdef __SSE2__
+      const __m128i f = _mm_set1_epi16(fy);
+      for (; x + 8 <= sw; x += 8) {
+        for (int k = 0; k < 8; k += 4) {
+          __m128i a = _mm_loadu_si128((const __m128i *)(r0 + x + k));
+          __m128i b = _mm_loadu_si128((const __m128i *)(r1 + x + k));
+          _mm_storeu_si128((__m128i *)(&column[x + k]), lerp4(a, b, f, f));
+        }
+      }
+#endif
+      for (; x < sw; x++)
+        column[x] = lerp(r0[x], r1[x], fy);
+
+      // Horizontal pass, neighbours gathered per destination pixel
+      x = 0;
+#ifdef __SSE2__
+      for (; x + 8 <= w; x += 8) {
+        for (int k = x; k < x + 8; k += 4) {
+          const Tap *t = &xs[k];
+          __m128i a = _mm_set_epi32(column[t[3].s0], column[t[2].s0], column[t[1].s0], column[t[0].s0]);
+          __m128i b = _mm_set_epi32(column[t[3].s1], column[t[2].s1], column[t[1].s1], column[t[0].s1]);
+          __m128i f_lo = _mm_set_epi16(t[1].f, t[1].f, t[1].f, t[1].f, t[0].f, t[0].f, t[0].f, t[0].f);
+          __m128i f_hi = _mm_set_epi16(t[3].f, t[3].f, t[3].f, t[3].f, t[2].f, t[2].f, t[2].f, t[2].f);
+          _mm_storeu_si128((__m128i *)(&row[k]), lerp4(a, b, f_lo, f_hi));
+        }
+      }
+#endif
+      for (; x < w; x++)
+        row[x] = lerp(column[xs[x].s0], column[xs[x].s1], xs[x].f);
+
+      Color *dst = &pixels[y * w];
+      if (sprite.translucent) {
+        std::copy(row.begin(), row.end(), reinterpret_cast<uint32_t *>(dst));
+        continue;
+      }
+      // Keep edges hard, so the sprite can still be drawn without blending
+      for (x = 0; x < w; x++) {
+        uint32_t p = row[x], a = p >> 24;
+        if (a < filter_one) {
+          dst[x] = Color{0, 0, 0, 0};
+          continue;
+        }
+        auto channel = [&](int shift) {
+          return (uint8_t)std::min<uint32_t>(255, ((p >> shift & 0xff) * unpremultiply[a] + (1 << 15)) >> 16);
+        };
+        dst[x] = Color{channel(0), channel(8), channel(16)};
+      }
+    }
+    return Sprite::fromPixels(w, h, std::move(pixels));
   }
-  if (lines.back().empty())
-    lines.pop_back();
+}
 
-  assert(!lines.empty());
-  size_t sz = lines.front().size();
-  for (auto &line : lines)
-    assert(line.size() == sz);
+Sprite scale(const Sprite &sprite, int w, int h, Filter filter) {
+  const Sprite &level = sprite.level(w, h);
+  if (filter == Filter::Bilinear)
+    return scaleBilinear(level, w, h);
+  return scaleNearest(level, w, h);
+}
 
-  return Sprite{std::move(lines)};
+Sprite turn(const Sprite &sprite, int angle_step) {
+  AffineMap map = AffineMap::rotated(0, 0, sprite.width(), sprite.height(), angle_step);
+  const Rect &b = map.bounds;
+  int w = b.x1 - b.x0, h = b.y1 - b.y0;
+  std::vector<Color> pixels(w * h, Color{0, 0, 0, 0});
+  for (int y = b.y0; y < b.y1; y++) {
+    int x0, x1;
+    map.span(y, x0, x1);
+    x0 = std::max(x0, b.x0), x1 = std::min(x1, b.x1);
+    if (x0 < x1)
+      map.row(sprite, y, x0, x1, &pixels[(y - b.y0) * w + (x0 - b.x0)]);
+  }
+  return Sprite::fromPixels(w, h, std::move(pixels));
 }
 
+namespace {
+  struct ScaledKey {
+    const Sprite *sprite;
+    int w, h;
+    Filter filter;
+    int angle_step;
+
+    bool operator==(const ScaledKey &o) const {
+      return sprite == o.sprite && w == o.w && h == o.h && filter == o.filter && angle_step == o.angle_step;
+    }
+  };
+
+  struct ScaledKeyHash {
+    size_t operator()(const ScaledKey &k) const {
+      return std::hash<const void *>()(k.sprite) ^ (size_t(k.angle_step) << 40 | size_t(k.filter) << 32 | size_t(k.w) << 16 | size_t(k.h)) * 0x9e3779b97f4a7c15ull;
+    }
+  };
+
+  // Asteroid radii come from a handful of sizes but every asteroid has its
+  // own angle, so a dense scene needs an entry per asteroid. When the entry
+  // to evict was used in the last two rounds through the cache, the sprites
+  // in use don't fit and it grows instead, up to a limit.
+  constexpr size_t scaled_cache_min = 256, scaled_cache_max = 4096;
+
+  // Evicted sprites live on while some blit still holds them. Until it is
+  // made, the sprite of an entry is a future the tiles that miss wait on.
+  struct ScaledEntry {
+    ScaledKey key;
+    std::shared_future<std::shared_ptr<const Sprite>> sprite;
+    uint64_t used; // lookup count when it was last used
+  };
+  std::list<ScaledEntry> scaled_lru; // most recently used first
+  std::unordered_map<ScaledKey, std::list<ScaledEntry>::iterator, ScaledKeyHash> scaled_index;
+  size_t scaled_cache_size = scaled_cache_min;
+  uint64_t scaled_lookups = 0;
+  std::mutex scaled_mutex;
+}
 
-std::string string_hearth = R"(
+std::shared_ptr<const Sprite> scaled(const Sprite &sprite, int w, int h, Filter filter, int angle_step) {
+  ScaledKey key{&sprite, w, h, filter, angle_step};
+  std::unique_lock<std::mutex> lock(scaled_mutex);
+  uint64_t now = ++scaled_lookups;
+  auto it = scaled_index.find(key);
+  if (it != scaled_index.end()) {
+    scaled_lru.splice(scaled_lru.begin(), scaled_lru, it->second);
+    it->second->used = now;
+    std::shared_future<std::shared_ptr<const Sprite>> res = it->second->sprite;
+    lock.unlock();
+    return res.get();
+  }
+
+  if (scaled_lru.size() >= scaled_cache_size) {
+    if (now - scaled_lru.back().used <= 2 * scaled_cache_size && scaled_cache_size < scaled_cache_max) {
+      scaled_cache_size *= 2;
+    } else {
+      scaled_index.erase(scaled_lru.back().key);
+      scaled_lru.pop_back();
+    }
+  }
+  std::promise<std::shared_ptr<const Sprite>> made;
+  scaled_lru.push_front(ScaledEntry{key, made.get_future().share(), now});
+  scaled_index[key] = scaled_lru.begin();
+  lock.unlock();
+
+  auto res = std::make_shared<const Sprite>(
+    angle_step ? turn(*scaled(sprite, w, h, filter), angle_step) : scale(sprite, w, h, filter));
+  made.set_value(res);
+  return res;
+}
+
+namespace {
+  // Palette indices from 1 on, in this order, so the built-in art knows
+  // its indices at compile time
+  constexpr Color art_colors[] = {
+    colors::white,
+    colors::sexyRed,
+    {0x41, 0x4c, 0x6d}, {0x23, 0x27, 0x3e},
+    {0x00, 0x69, 0x5c}, {0x00, 0x4d, 0x40},
+    {0x15, 0x43, 0xd8}, {0x0c, 0x36, 0xbf},
+  };
+
+  constexpr uint8_t artIndex(Color c) {
+    if (c.a == 0) return 0;
+    for (int i = 0; i < (int)std::size(art_colors); i++) {
+      Color a = art_colors[i];
+      if (a.b == c.b && a.g == c.g && a.r == c.r && a.a == c.a)
+        return i + 1;
+    }
+    artCheck(false, "color is not in art_colors");
+    return 0;
+  }
+}
+
+Palette::Palette() {
+  std::fill(values, values + slots, -1);
+  keys[slot(0)] = 0, values[slot(0)] = 0;
+  for (Color c : art_colors)
+    add(c);
+  assert(size == 1 + (int)std::size(art_colors)); // no duplicates, artIndex() counts on it
+}
+
+uint8_t Palette::add(Color c) {
+  int i = find(c);
+  if (i >= 0) return i;
+  if (size == max_size) return index(c);
+
+  uint32_t key = toPixel(c);
+  int k = slot(key);
+  while (values[k] >= 0)
+    k = (k + 1) % slots;
+  keys[k] = key, values[k] = size;
+  table[size] = key;
+  return size++;
+}
+
+int Palette::find(Color c) const {
+  uint32_t key = toPixel(c);
+  for (int k = slot(key); values[k] >= 0; k = (k + 1) % slots)
+    if (keys[k] == key)
+      return values[k];
+  return -1;
+}
+
+uint8_t Palette::index(Color c) const {
+  int i = find(c);
+  if (i >= 0) return i;
+  int best = 0, best_d = INT32_MAX;
+  for (int k = 0; k < size; k++) {
+    Color p = toColor(table[k]);
+    int db = p.b - c.b, dg = p.g - c.g, dr = p.r - c.r, da = p.a - c.a;
+    int d = db * db + dg * dg + dr * dr + da * da;
+    if (d < best_d)
+      best = k, best_d = d;
+  }
+  return best;
+}
+
+Palette &palette() {
+  static Palette res;
+  return res;
+}
+
+namespace {
+  // Sizes of the arrays of a sprite and all its mips
+  struct MipTotals {
+    int levels = 0, pixels = 0, spans = 0, rows = 0;
+  };
+
+  constexpr MipTotals mipTotals(int w, int h) {
+    MipTotals res;
+    while (true) {
+      res.levels++;
+      res.pixels += w * h;
+      res.spans += h * ((w + 1) / 2); // at most
+      res.rows += h + 1;
+      if (w == 1 && h == 1) return res;
+      w = (w + 1) / 2, h = (h + 1) / 2;
+    }
+  }
+
+  // W x H sprite made from a string at compile time, with its mips, all in
+  // flat arrays. '.' is transparent and digit i color i of the pallete,
+  // empty lines are skipped. The colors have to be in art_colors.
+  template <int W, int H>
+  struct Art {
+    static constexpr MipTotals totals = mipTotals(W, H);
+
+    struct Level {
+      int w, h;
+      int pixels, spans, rows; // where its part of the arrays starts
+      bool masked, translucent;
+    };
+
+    Level levels[totals.levels] = {};
+    Color pixels[totals.pixels] = {};
+    Span spans[totals.spans] = {};
+    int row_spans[totals.rows] = {};
+    uint8_t indices[W * H] = {}; // of the first level only
+
+    constexpr Art(std::string_view s, std::initializer_list<Color> pallete) {
+      int n = 0, x = 0;
+      for (char c : s) {
+        if (c == '\n') {
+          artCheck(x == 0 || x == W, "art row is not W pixels");
+          x = 0;
+          continue;
+        }
+        artCheck(x < W && n < W * H, "art is over W x H");
+        artCheck(c == '.' || ('0' <= c && c - '0' < (int)pallete.size()), "art pixel is not '.' or a pallete index");
+        pixels[n] = c == '.' ? Color{0, 0, 0, 0} : pallete.begin()[c - '0'];
+        indices[n] = artIndex(pixels[n]);
+        n++, x++;
+      }
+      artCheck((x == 0 || x == W) && n == W * H, "art is not W x H");
+
+      int w = W, h = H, first_pixel = 0, first_span = 0, first_row = 0;
+      for (int k = 0; k < totals.levels; k++) {
+        const Color *level = pixels + first_pixel;
+        bool translucent = anyTranslucent(level, w * h);
+        int count = 0;
+        for (int y = 0; y < h; y++) {
+          row_spans[first_row + y] = count;
+          forSpans(level + y * w, w, [&](int start, int len) { spans[first_span + count++] = Span{start, len}; });
+        }
+        row_spans[first_row + h] = count;
+        levels[k] = Level{w, h, first_pixel, first_span, first_row, preferMask(count, w, h), translucent};
+
+        if (k + 1 < totals.levels)
+          downsample(level, w, h, translucent, pixels + first_pixel + w * h);
+        first_pixel += w * h, first_span += count, first_row += h + 1;
+        w = (w + 1) / 2, h = (h + 1) / 2;
+      }
+    }
+  };
+
+  // Sprites over the mip levels of art, each pointing at the next
+  template <const auto &art, class = std::make_index_sequence<std::decay_t<decltype(art)>::totals.levels - 1>>
+  struct ArtMips;
+
+  template <const auto &art, size_t... k>
+  struct ArtMips<art, std::index_sequence<k...>> {
+    static const Sprite mips[sizeof...(k)];
+  };
+
+  template <const auto &art, size_t... k>
+  const Sprite ArtMips<art, std::index_sequence<k...>>::mips[] = {
+    Sprite(art, k + 1, k + 1 < sizeof...(k) ? &mips[k + 1] : nullptr)...
+  };
+}
+
+
+constexpr std::string_view string_hearth = R"(
 .00...00.
 0000.0000
 000000000
@@ -41,10 +509,12 @@ std::string string_hearth = R"(
 ....0....
 )";
 
-Sprite sprites::hearth = Sprite::fromString(string_hearth, {colors::sexyRed});
+constexpr Art<9, 7> hearth_art(string_hearth, {colors::sexyRed});
+
+const Sprite sprites::hearth(hearth_art, 0, ArtMips<hearth_art>::mips);
 
 
-std::string string_asteroid = R"(
+constexpr std::string_view string_asteroid = R"(
 ................
 .....0000000....
 ...11000110001..
@@ -63,10 +533,14 @@ std::string string_asteroid = R"(
 ................
 )";
 
-Sprite sprites::asteroids[3] = {
-  Sprite::fromString(string_asteroid, {{0x41, 0x4c, 0x6d}, {0x23, 0x27, 0x3e}}),
-  Sprite::fromString(string_asteroid, {{0x00, 0x69, 0x5c}, {0x00, 0x4d, 0x40}}),
-  Sprite::fromString(string_asteroid, {{0x15, 0x43, 0xd8}, {0x0c, 0x36, 0xbf}}),
+constexpr Art<16, 16> brown_asteroid(string_asteroid, {{0x41, 0x4c, 0x6d}, {0x23, 0x27, 0x3e}});
+constexpr Art<16, 16> olive_asteroid(string_asteroid, {{0x00, 0x69, 0x5c}, {0x00, 0x4d, 0x40}});
+constexpr Art<16, 16> orange_asteroid(string_asteroid, {{0x15, 0x43, 0xd8}, {0x0c, 0x36, 0xbf}});
+
+const Sprite sprites::asteroids[3] = {
+  Sprite(brown_asteroid, 0, ArtMips<brown_asteroid>::mips),
+  Sprite(olive_asteroid, 0, ArtMips<olive_asteroid>::mips),
+  Sprite(orange_asteroid, 0, ArtMips<orange_asteroid>::mips),
 };
 
-}
\ No newline at end of file
+}
@@ -1,135 +1,818 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 #include <utility>
 #include <algorithm>
 #include <string>
+#include <string_view>
+#include <stdexcept>
+#include <vector>
+#include <memory>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "Engine.h"
 #include "geometry.h"
 
 namespace display {
+  // Premultiplied: b, g and r never exceed a. 255 is opaque, 0 transparent.
   struct Color {
-    uint8_t b, g, r, o; // yes, o stands for opacity, treated binary
+    uint8_t b, g, r, a = 255;
   };
 
+  // Color as the 32-bit pixel it is stored as, and back
+  inline uint32_t toPixel(Color c) { uint32_t p; std::memcpy(&p, &c, sizeof p); return p; }
+  inline Color toColor(uint32_t p) { Color c; std::memcpy(static_cast<void *>(&c), &p, sizeof c); return c; }
+
   namespace colors {
     constexpr Color sexyRed{0x36, 0x43, 0xf4};
+    constexpr Color white{255, 255, 255};
+  }
+
+  // Opaque color c made a / 255 opaque
+  constexpr Color fade(Color c, uint8_t a) {
+    return Color{uint8_t(c.b * a / 255), uint8_t(c.g * a / 255), uint8_t(c.r * a / 255), a};
+  }
+
+  // Half-open pixel rectangle [x0, x1) x [y0, y1)
+  struct Rect {
+    int x0, y0, x1, y1;
+
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+
+    Rect intersect(Rect o) const {
+      return {std::max(x0, o.x0), std::max(y0, o.y0), std::min(x1, o.x1), std::min(y1, o.y1)};
+    }
+  };
+
+  constexpr Rect screen_rect{0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+
+  // Every pixel the points round to, with a pixel to spare
+  inline Rect boundsOf(const Vec *pts, int n) {
+    float x0 = pts[0].x, y0 = pts[0].y, x1 = x0, y1 = y0;
+    for (int i = 1; i < n; i++) {
+      x0 = std::min(x0, pts[i].x), x1 = std::max(x1, pts[i].x);
+      y0 = std::min(y0, pts[i].y), y1 = std::max(y1, pts[i].y);
+    }
+    return Rect{(int)std::floor(x0) - 1, (int)std::floor(y0) - 1, (int)std::ceil(x1) + 2, (int)std::ceil(y1) + 2};
+  }
+
+  // Colors of indexed surfaces, index 0 is transparent and 1 white, the
+  // color of text, then come the colors of the built-in art. Other colors
+  // should be added before drawing starts. Looking up a color that is not
+  // there gives the closest.
+  class Palette {
+  public:
+    static constexpr int max_size = 256;
+
+    Palette();
+
+    // Index of c, added if it is new and there is room
+    uint8_t add(Color c);
+    // Index of c, -1 if it is not there
+    int find(Color c) const;
+    // Index of c or of the closest color
+    uint8_t index(Color c) const;
+    uint8_t index(uint32_t c) const { return index(toColor(c)); }
+
+    // Color of every index, unused ones transparent
+    const uint32_t *colors() const { return table; }
+
+  private:
+    static constexpr int slots = 2 * max_size; // hash table, never more than half full
+    static int slot(uint32_t c) { return (c * 2654435761u) >> 23; }
+
+    uint32_t table[max_size] = {};
+    int size = 1;
+    uint32_t keys[slots];
+    int16_t values[slots]; // -1 for empty slots
+  };
+
+  Palette &palette();
+
+  // Pixels of a 64x64 window that already hold their final color, for
+  // drawing front to back. Bit i of rows[j] is pixel (x0 + i, y0 + j).
+  struct Coverage {
+    static constexpr int size = 64;
+    int x0, y0;
+    uint64_t rows[size];
+    // Off: covered pixels are still skipped, but drawing covers nothing new
+    bool marks = true;
+  };
+
+  // Image the primitives draw into, rows of `stride` pixels. Drawing is cut
+  // to `clip`, renderers narrow it down to the tile they work on.
+  struct Surface {
+    uint32_t *pixels;
+    int width, height, stride;
+    Rect clip;
+    // Set while a renderer draws front to back, clip must then be inside it
+    Coverage *coverage = nullptr;
+    // Indexed surfaces have a byte per pixel here instead of `pixels`, a
+    // palette() index. Nothing is blended, translucent colors replace what
+    // is there.
+    uint8_t *indices = nullptr;
+
+    static Surface of(uint32_t *pixels, int width, int height, int stride) {
+      return Surface{pixels, width, height, stride, Rect{0, 0, width, height}};
+    }
+
+    static Surface indexed(uint8_t *indices, int width, int height, int stride) {
+      return Surface{nullptr, width, height, stride, Rect{0, 0, width, height}, nullptr, indices};
+    }
+
+    Rect bounds() const { return Rect{0, 0, width, height}; }
+    uint32_t *row(int y) const { return pixels + (ptrdiff_t)y * stride; }
+    uint8_t *indexRow(int y) const { return indices + (ptrdiff_t)y * stride; }
+
+    // The same pixels, drawing cut to r as well
+    Surface clipped(Rect r) const {
+      Surface s = *this;
+      s.clip = clip.intersect(r);
+      return s;
+    }
+  };
+
+  // The backbuffer
+  inline Surface screen() {
+    return Surface::of(&buffer[0][0], SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH);
   }
 
-  inline bool onScreen(int x, int y) {
+  inline bool onScreen(const Surface &s, int x, int y) {
     return (
-         0 <= x && x < SCREEN_WIDTH
-      && 0 <= y && y < SCREEN_HEIGHT
+         s.clip.x0 <= x && x < s.clip.x1
+      && s.clip.y0 <= y && y < s.clip.y1
     );
   }
 
-  inline Color& at(int x, int y) {
-    assert(onScreen(x, y));
-    return reinterpret_cast<Color&>(buffer[y][x]);
+  inline Color& at(const Surface &s, int x, int y) {
+    assert(onScreen(s, x, y) && !s.indices);
+    return reinterpret_cast<Color&>(s.row(y)[x]);
   }
 
-  inline int clip_x(int x) { return std::max(0, std::min(x, SCREEN_WIDTH  - 1)); }
-  inline int clip_y(int y) { return std::max(0, std::min(y, SCREEN_HEIGHT - 1)); }
+  // Bits [a, b) of a word
+  inline uint64_t bitRange(int a, int b) {
+    assert(0 <= a && a <= b && b <= 64);
+    return (b - a == 64 ? ~uint64_t(0) : ((uint64_t(1) << (b - a)) - 1)) << a;
+  }
 
-  inline void rect(Color color, int x0, int y0, int w, int h) {
-    if (x0 + w <= 0 || x0 >= SCREEN_WIDTH) return;
-    if (y0 + h <= 0 || y0 >= SCREEN_HEIGHT) return;
+  // Calls fn(x0 + start, x0 + end) for every run [start, end) of set bits
+  template <class Fn>
+  inline void forRuns(uint64_t bits, int x0, Fn &&fn) {
+    while (bits) {
+      int start = __builtin_ctzll(bits);
+      uint64_t rest = ~(bits >> start);
+      int len = rest ? __builtin_ctzll(rest) : 64 - start;
+      fn(x0 + start, x0 + start + len);
+      bits &= ~bitRange(start, start + len);
+    }
+  }
 
-    int x1 = x0 + w - 1, y1 = y0 + h - 1;
-    x0 = clip_x(x0), x1 = clip_x(x1), y0 = clip_y(y0), y1 = clip_y(y1);
+  // Calls fn(from, to) for the runs of [x0, x1) in row y not covered yet.
+  // `covers` are the bits of the range to mark covered, relative to x0.
+  template <class Fn>
+  inline void forUncovered(const Surface &s, int y, int x0, int x1, uint64_t covers, Fn &&fn) {
+    Coverage *coverage = s.coverage;
+    if (!coverage) {
+      fn(x0, x1);
+      return;
+    }
+    int cx = coverage->x0;
+    uint64_t &row = coverage->rows[y - coverage->y0];
+    uint64_t todo = bitRange(x0 - cx, x1 - cx) & ~row;
+    if (coverage->marks)
+      row |= covers << (x0 - cx);
+    forRuns(todo, cx, fn);
+  }
 
-    for (int y = y0; y <= y1; y++)
-      std::fill(&buffer[y][x0], &buffer[y][x1] + 1,
-                reinterpret_cast<uint32_t&>(color));
+  // Same, marking the whole range covered
+  template <class Fn>
+  inline void forUncovered(const Surface &s, int y, int x0, int x1, Fn &&fn) {
+    forUncovered(s, y, x0, x1, s.coverage ? bitRange(0, x1 - x0) : 0, fn);
   }
 
-  inline void rect(Color color, float x0, float y0, float w, float h) {
-    rect(color, (int)std::round(x0), (int)std::round(y0), (int)std::round(w), (int)std::round(h));
+  // Bit i set if src[i] is opaque, n <= 64
+  inline uint64_t opaqueBits(const Color *src, int n) {
+    uint64_t res = 0;
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    for (; i + 4 <= n; i += 4) {
+      __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha);
+      res |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(opaque))) << i;
+    }
+#endif
+    for (; i < n; i++)
+      res |= uint64_t(src[i].a == 255) << i;
+    return res;
   }
 
-  inline void line(Color color, Vec p1, Vec p2) {
-    using std::abs, std::round, std::swap;
-    if (abs(p1.x - p2.x) >= abs(p1.y - p2.y)) {
-      if (p1.x > p2.x)
-        swap(p1, p2);
-      for (int x = round(p1.x); x <= round(p2.x); x++) {
-        int y = round(p1.y + (x - p1.x) / (p2.x - p1.x) * (p2.y - p1.y));
-        if (onScreen(x, y))
-          at(x, y) = color;
+  // Premultiplied src over dst, d * (255 - a) / 255 rounded exactly
+  inline uint32_t over(uint32_t src, uint32_t dst) {
+    uint32_t inv = 255 - (src >> 24), res = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint32_t t = (dst >> shift & 0xff) * inv + 128;
+      uint32_t c = (src >> shift & 0xff) + ((t + (t >> 8)) >> 8);
+      res |= std::min(c, 255u) << shift;
+    }
+    return res;
+  }
+
+#ifdef __SSE2__
+  // over() for 4 pixels
+  inline __m128i over4(__m128i s, __m128i d) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    __m128i inv = _mm_xor_si128(_mm_srli_epi32(s, 24), _mm_set1_epi32(255));
+    inv = _mm_or_si128(inv, _mm_slli_epi32(inv, 8));
+    inv = _mm_or_si128(inv, _mm_slli_epi32(inv, 16));
+    auto scale = [&](__m128i c, __m128i f) {
+      __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, f), half);
+      return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    };
+    __m128i lo = scale(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inv, zero));
+    __m128i hi = scale(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inv, zero));
+    return _mm_adds_epu8(s, _mm_packus_epi16(lo, hi));
+  }
+#endif
+
+  // src[i] over dst[i] for the first n pixels, src_step 0 repeats src[0]
+  inline void blendPixels(const uint32_t *src, int src_step, uint32_t *dst, int n) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i same = _mm_set1_epi32(src[0]);
+    for (; i + 8 <= n; i += 8) {
+      for (int k = i; k < i + 8; k += 4) {
+        __m128i s = src_step ? _mm_loadu_si128((const __m128i *)(src + k)) : same;
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + k));
+        _mm_storeu_si128((__m128i *)(dst + k), over4(s, d));
       }
-    } else {
-      if (p1.y > p2.y)
-        swap(p1, p2);
-      for (int y = round(p1.y); y <= round(p2.y); y++) {
-        int x = round(p1.x + (y - p1.y) / (p2.y - p1.y) * (p2.x - p1.x));
-        if (onScreen(x, y))
-          at(x, y) = color;
+    }
+#endif
+    for (; i < n; i++)
+      dst[i] = over(src[i * src_step], dst[i]);
+  }
+
+  // Row y, columns [from, to) of the surface to c, whatever covers them
+  inline void fillPixels(const Surface &s, int y, int from, int to, uint32_t c) {
+    if (s.indices)
+      std::fill(s.indexRow(y) + from, s.indexRow(y) + to, palette().index(c));
+    else
+      std::fill(s.row(y) + from, s.row(y) + to, c);
+  }
+
+  // Row y, columns [x0, x1) of the surface to one color
+  inline void fillRow(const Surface &s, int y, int x0, int x1, Color color) {
+    if (s.indices) {
+      uint8_t i = palette().index(color);
+      if (color.a != 0) {
+        uint64_t covers = s.coverage && color.a == 255 ? bitRange(0, x1 - x0) : 0;
+        forUncovered(s, y, x0, x1, covers, [&](int from, int to) {
+          std::fill(s.indexRow(y) + from, s.indexRow(y) + to, i);
+        });
       }
+      return;
+    }
+
+    uint32_t c = reinterpret_cast<uint32_t &>(color);
+    uint32_t *row = s.row(y);
+    if (color.a == 255) {
+      forUncovered(s, y, x0, x1, [&](int from, int to) {
+        std::fill(row + from, row + to, c);
+      });
+    } else if (color.a != 0) {
+      forUncovered(s, y, x0, x1, 0, [&](int from, int to) {
+        blendPixels(&c, 0, row + from, to - from);
+      });
     }
   }
 
-  inline void circle(Color color, Vec p, float r) {
-    using std::abs, std::round;
+  // Row y, columns [x0, x1) of the surface from src, src[0] goes to x0. Not
+  // for indexed surfaces, like the rest of the row functions below.
+  inline void copyRow(const Surface &s, int y, int x0, int x1, const Color *src) {
+    Color *row = reinterpret_cast<Color *>(s.row(y));
+    forUncovered(s, y, x0, x1, [&](int from, int to) {
+      std::copy(src + (from - x0), src + (to - x0), row + from);
+    });
+  }
 
-    int y0 = clip_y(std::floor(p.y - r));
-    int y1 = clip_y(std::ceil(p.y + r));
+  // Like copyRow, but blends src over what is there
+  inline void blendRow(const Surface &s, int y, int x0, int x1, const Color *src) {
+    uint64_t covers = s.coverage ? opaqueBits(src, x1 - x0) : 0;
+    uint32_t *row = s.row(y);
+    forUncovered(s, y, x0, x1, covers, [&](int from, int to) {
+      blendPixels(reinterpret_cast<const uint32_t *>(src + (from - x0)), 1, row + from, to - from);
+    });
+  }
 
-    int x0 = std::round(p.x), x1 = std::round(p.x);
-    for (int y = y0; y <= y1; y++) {
-      auto isInside = [y, r, p](int x) {
-        return (Vec{(float)x, (float)y} - p).len() <= r;
-      };
+  inline void plot(const Surface &s, int x, int y, uint32_t color) {
+    bool opaque = color >> 24 == 255;
+    if (Coverage *coverage = s.coverage) {
+      uint64_t bit = uint64_t(1) << (x - coverage->x0);
+      uint64_t &row = coverage->rows[y - coverage->y0];
+      if (row & bit) return;
+      if (opaque && coverage->marks) row |= bit;
+    }
+    if (s.indices) {
+      s.indexRow(y)[x] = palette().index(color);
+      return;
+    }
+    uint32_t &p = s.row(y)[x];
+    p = opaque ? color : over(color, p);
+  }
+
+  inline int clip_x(const Surface &s, int x) { return std::max(s.clip.x0, std::min(x, s.clip.x1 - 1)); }
+  inline int clip_y(const Surface &s, int y) { return std::max(s.clip.y0, std::min(y, s.clip.y1 - 1)); }
+
+  inline void rect(const Surface &s, Color color, int x0, int y0, int w, int h) {
+    const Rect &clip = s.clip;
+    if (x0 + w <= clip.x0 || x0 >= clip.x1) return;
+    if (y0 + h <= clip.y0 || y0 >= clip.y1) return;
+
+    int x1 = x0 + w - 1, y1 = y0 + h - 1;
+    x0 = clip_x(s, x0), x1 = clip_x(s, x1), y0 = clip_y(s, y0), y1 = clip_y(s, y1);
+
+    for (int y = y0; y <= y1; y++)
+      fillRow(s, y, x0, x1 + 1, color);
+  }
+
+  inline void rect(const Surface &s, Color color, float x0, float y0, float w, float h) {
+    rect(s, color, (int)std::round(x0), (int)std::round(y0), (int)std::round(w), (int)std::round(h));
+  }
+
+  // Integer DDA along the major axis. The range of the major coordinate is
+  // clipped up front, so only visible pixels are visited.
+  inline void line(const Surface &s, Color color, Vec p1, Vec p2) {
+    using std::abs, std::swap;
+    const Rect &clip = s.clip;
+
+    bool steep = abs(p1.y - p2.y) > abs(p1.x - p2.x);
+    if (steep) { // work with x as the major axis
+      swap(p1.x, p1.y);
+      swap(p2.x, p2.y);
+    }
+    if (p1.x > p2.x)
+      swap(p1, p2);
+    int major_lo = steep ? clip.y0 : clip.x0, major_hi = steep ? clip.y1 : clip.x1;
+    int minor_lo = steep ? clip.x0 : clip.y0, minor_hi = steep ? clip.x1 : clip.y1;
+
+    int xa = std::round(p1.x), xb = std::round(p2.x);
+    if (xb < major_lo || xa >= major_hi) return;
+
+    float slope = p2.x > p1.x ? (p2.y - p1.y) / (p2.x - p1.x) : 0;
+
+    // Minor coordinate of pixel x is floor(y) in 32.32 fixed point, y already
+    // holds the +0.5 for rounding
+    constexpr double one = 4294967296.0;
+    int64_t base = std::max(xa, major_lo);
+    int64_t y0 = std::llround((p1.y + (base - p1.x) * (double)slope + 0.5) * one);
+    int64_t dy = std::llround(slope * one);
+    auto minorAt = [&](int64_t x) { return (y0 + (x - base) * dy) >> 32; };
+    auto visible = [&](int64_t x) { auto y = minorAt(x); return minor_lo <= y && y < minor_hi; };
+
+    // Clip the minor axis: solve for where the line leaves the clip rect,
+    // then fix up the float estimate on the exact integer path
+    int64_t lo = base, hi = std::min(xb, major_hi - 1);
+    if (dy != 0) {
+      float enter = p1.x + ((dy > 0 ? minor_lo : minor_hi) - 0.5f - p1.y) / slope;
+      float leave = p1.x + ((dy > 0 ? minor_hi : minor_lo) - 0.5f - p1.y) / slope;
+      lo = std::max<int64_t>(lo, std::floor(enter) - 1);
+      hi = std::min<int64_t>(hi, std::ceil(leave) + 1);
+    }
+    while (lo <= hi && !visible(lo)) lo++;
+    while (lo <= hi && !visible(hi)) hi--;
+
+    uint32_t c = reinterpret_cast<uint32_t&>(color);
+    int64_t y = y0 + (lo - base) * dy;
+    for (int64_t x = lo; x <= hi; x++, y += dy) {
+      if (steep)
+        plot(s, y >> 32, x, c);
+      else
+        plot(s, x, y >> 32, c);
+    }
+  }
+
+  // Connected line segments through n points, back to the first if closed
+  inline void polyline(const Surface &s, Color color, const Vec *pts, int n, bool closed = false) {
+    for (int i = 0; i + 1 < n; i++)
+      line(s, color, pts[i], pts[i + 1]);
+    if (closed && n > 2)
+      line(s, color, pts[n - 1], pts[0]);
+  }
 
-      while (!isInside(x0 + 1) && x0 + 1 < p.x) x0++;
-      while (isInside(x0)) x0--;
+  // Half widths of the rows of a filled circle, the pixels (dx, dy) with
+  // dx^2 + dy^2 <= t for dy = 0, 1, ... Midpoint style, no square roots.
+  inline std::vector<int> circleSpans(int t) {
+    std::vector<int> half;
+    int hw = 0;
+    while ((hw + 1) * (hw + 1) <= t) hw++;
+    for (int dy = 0; dy * dy <= t; dy++) {
+      while (hw * hw + dy * dy > t) hw--;
+      half.push_back(hw);
+    }
+    return half;
+  }
+
+  // circleSpans(t), precomputed for the small circles like projectiles
+  const std::vector<int> &cachedCircleSpans(int t);
+  constexpr int circle_cache_max = 32 * 32;
 
-      while (!isInside(x1 - 1) && x1 - 1 > p.x) x1--;
-      while (isInside(x1)) x1++;
+  // Pixels whose centers are within r + 0.5 of the rounded center
+  inline void circle(const Surface &s, Color color, Vec p, float r) {
+    if (r < 0) return;
+    const Rect &clip = s.clip;
+    int cx = std::round(p.x), cy = std::round(p.y);
+    int t = (r + 0.5f) * (r + 0.5f);
 
-      if (x1 < 0 || x0 >= SCREEN_WIDTH) continue;
+    std::vector<int> own;
+    const std::vector<int> &half = t <= circle_cache_max ? cachedCircleSpans(t) : (own = circleSpans(t));
 
-      std::fill(&buffer[y][clip_x(x0)], &buffer[y][clip_x(x1)] + 1,
-          reinterpret_cast<uint32_t&>(color));
+    int n = half.size() - 1;
+    if (cx + n < clip.x0 || cx - n >= clip.x1) return;
+    int y0 = std::max(cy - n, clip.y0), y1 = std::min(cy + n, clip.y1 - 1);
+    for (int y = y0; y <= y1; y++) {
+      int hw = half[std::abs(y - cy)];
+      int x0 = std::max(cx - hw, clip.x0), x1 = std::min(cx + hw, clip.x1 - 1);
+      if (x0 <= x1)
+        fillRow(s, y, x0, x1 + 1, color);
     }
   }
 
+  // Runs of pixels that are not transparent in a row
+  struct Span {
+    int start, len;
+  };
+
   struct Sprite {
-    static Sprite fromString(std::string s, std::vector<Color> pallete);
+    static Sprite fromPixels(int w, int h, std::vector<Color> pixels, std::vector<uint8_t> indices = {});
+
+    // Level k of art worked out at compile time (see Art in display.cpp),
+    // nothing is copied
+    template <class Art>
+    constexpr Sprite(const Art &art, int k, const Sprite *half)
+      : w(art.levels[k].w), h(art.levels[k].h),
+        pixels(art.pixels + art.levels[k].pixels), spans(art.spans + art.levels[k].spans),
+        row_spans(art.row_spans + art.levels[k].rows),
+        masked(art.levels[k].masked), translucent(art.levels[k].translucent),
+        half(half), indices(k == 0 ? art.indices : nullptr) {}
+
+    int w, h;
+    const Color *pixels;   // row-major
+    const Span *spans;     // row by row
+    const int *row_spans;  // spans of row y are [row_spans[y], row_spans[y + 1])
+    bool masked; // too many short spans, blit whole rows with a mask instead
+    bool translucent; // some pixels are neither opaque nor transparent, blend them
+    const Sprite *half; // next mip level, half the size, down to 1x1. Null for sprites made at run time.
+    const uint8_t *indices; // palette() index of every pixel, for the built-in art and its
+                            // nearest neighbour scalings, otherwise null
+
+    int width()  const { return w; }
+    int height() const { return h; }
+    Color at(int x, int y) const { return pixels[y * w + x]; }
+    const Color *row(int y) const { return &pixels[y * w]; }
+    const uint8_t *indexRow(int y) const { return &indices[y * w]; }
+    bool empty() const { return row_spans[h] == 0; }
+
+    // Smallest mip level still at least w x h
+    const Sprite &level(int w, int h) const {
+      const Sprite *res = this;
+      for (const Sprite *mip = half; mip && mip->w >= w && mip->h >= h; mip = mip->half)
+        res = mip;
+      return *res;
+    }
+
+  private:
+    Sprite() = default;
+
+    // Arrays of the sprites made at run time
+    struct Storage;
+    std::shared_ptr<const Storage> storage;
+  };
+
+  enum class Filter : uint8_t {
+    Nearest,
+    Bilinear, // sprites without translucent pixels stay that way: opaque where at
+              // least half the weight is, averaging opaque neighbours only
+  };
+
+  // Resampling of the closest mip level, corners map to corners
+  Sprite scale(const Sprite &sprite, int w, int h, Filter filter = Filter::Nearest);
+
+  // The sprite turned counter-clockwise on screen by angle_step (see
+  // angleStep), sized to AffineMap::rotated(0, 0, w, h, angle_step).bounds
+  Sprite turn(const Sprite &sprite, int angle_step);
+
+  // Cached turn(scale(sprite, w, h, filter), angle_step), least recently used
+  // entries are dropped. Safe to call from several threads.
+  std::shared_ptr<const Sprite> scaled(const Sprite &sprite, int w, int h, Filter filter = Filter::Nearest,
+                                       int angle_step = 0);
+
+  // For art parsed at compile time: a throw cannot be constant evaluated,
+  // so bad art fails the build, with or without NDEBUG
+  constexpr void artCheck(bool ok, const char *what) {
+    if (!ok) throw std::logic_error(what);
+  }
 
-    std::vector<std::vector<Color>> grid;
+  // 32 x 32 image with a bit per pixel, bit x of rows[y] is pixel (x, y)
+  struct Glyph {
+    // Rows of '0' for set and '.' for clear pixels, each ending in '\n'
+    static constexpr Glyph fromString(std::string_view s) {
+      Glyph res{};
+      int x = 0, y = 0;
+      for (char c : s) {
+        if (c == '\n') {
+          artCheck(x == 32, "glyph row is not 32 pixels");
+          x = 0, y++;
+        } else {
+          artCheck(c == '.' || c == '0', "glyph pixel is not '.' or '0'");
+          artCheck(x < 32 && y < 32, "glyph is over 32 x 32");
+          res.rows[y] |= uint32_t(c == '0') << x++;
+        }
+      }
+      artCheck(y == 32 && x == 0, "glyph is not 32 rows");
+      return res;
+    }
 
-    int width()  const { return grid.front().size(); }
-    int height() const { return grid.size(); }
-    Color at(int x, int y) const { return grid[y][x]; }
+    uint32_t rows[32];
   };
 
+  // Made at compile time, read-only
   namespace sprites {
-    extern Sprite hearth;
-    extern Sprite asteroids[3];
-    extern Sprite ascii[128];
+    extern const Sprite hearth;
+    extern const Sprite asteroids[3];
+    extern const Glyph ascii[128];
     constexpr int font_size = 32;
   }
 
-  inline void sprite(int x0, int y0, int w, int h, const Sprite &sprite) {
-    for (int y = y0; y < y0 + h; y++)
-    for (int x = x0; x < x0 + w; x++) {
-      if (!onScreen(x, y)) continue;
-      int sx = std::round((float)(x - x0) / (w - 1) * (sprite.width() - 1));
-      int sy = std::round((float)(y - y0) / (h - 1) * (sprite.height() - 1));
-      assert(sx < sprite.width());
-      assert(sy < sprite.height());
-      if (sprite.at(sx, sy).o == 0)
-        at(x, y) = sprite.at(sx, sy);
+  // Copies the pixels among the first n of src that are not transparent to
+  // dst, for sprites without translucent pixels
+  inline void maskedCopy(const Color *src, Color *dst, int n) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+      for (int k = 0; k < 8; k += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i + k));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i + k));
+        __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), zero);
+        d = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, s));
+        _mm_storeu_si128((__m128i *)(dst + i + k), d);
+      }
+    }
+#endif
+    for (; i < n; i++)
+      if (src[i].a != 0)
+        dst[i] = src[i];
+  }
+
+  // Visible pixels of src to row y, columns [x0, x1) of the surface, for
+  // sprites without translucent pixels
+  inline void maskedRow(const Surface &s, int y, int x0, int x1, const Color *src) {
+    Color *row = reinterpret_cast<Color *>(s.row(y));
+    if (!s.coverage) {
+      maskedCopy(src, row + x0, x1 - x0);
+      return;
     }
+    uint64_t opaque = opaqueBits(src, x1 - x0);
+    forUncovered(s, y, x0, x1, opaque, [&](int from, int to) {
+      maskedCopy(src + (from - x0), row + from, to - from);
+    });
+  }
+
+  // Copies the first n of src that are not 0, the transparent index, to dst
+  inline void maskedCopy(const uint8_t *src, uint8_t *dst, int n) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+      __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+      __m128i clear = _mm_cmpeq_epi8(s, zero);
+      d = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, s));
+      _mm_storeu_si128((__m128i *)(dst + i), d);
+    }
+#endif
+    for (; i < n; i++)
+      if (src[i] != 0)
+        dst[i] = src[i];
+  }
+
+  // blit() for indexed surfaces. Sprites without indices, like scaled or
+  // turned ones, get the closest palette colors, looked up once per color.
+  inline void blitIndices(const Surface &dst, const Sprite &src, int sx0, int sy0, int x0, int y0, int x1, int y1) {
+    std::vector<uint8_t> closest;
+    // Last color seen in each slot and its index, transparent to start with
+    constexpr int slots = 256;
+    uint32_t seen[slots] = {};
+    uint8_t seen_index[slots] = {};
+    auto closestIndex = [&](Color c) {
+      uint32_t key = toPixel(c);
+      int k = (key * 2654435761u) >> 24;
+      if (seen[k] != key)
+        seen[k] = key, seen_index[k] = c.a ? palette().index(c) : 0;
+      return seen_index[k];
+    };
+
+    for (int y = y0; y < y1; y++) {
+      const uint8_t *s;
+      if (src.indices) {
+        s = src.indexRow(y - sy0) + (x0 - sx0);
+      } else {
+        closest.resize(x1 - x0);
+        for (int x = x0; x < x1; x++)
+          closest[x - x0] = closestIndex(src.at(x - sx0, y - sy0));
+        s = closest.data();
+      }
+      uint8_t *row = dst.indexRow(y);
+      uint64_t covers = dst.coverage ? opaqueBits(src.row(y - sy0) + (x0 - sx0), x1 - x0) : 0;
+      forUncovered(dst, y, x0, x1, covers, [&](int from, int to) {
+        maskedCopy(s + (from - x0), row + from, to - from);
+      });
+    }
+  }
+
+  // Blits rows [y0, y1) and columns [x0, x1) of the surface from src placed
+  // at (sx0, sy0), both ranges already clipped
+  inline void blit(const Surface &dst, const Sprite &src, int sx0, int sy0, int x0, int y0, int x1, int y1) {
+    if (dst.indices) {
+      blitIndices(dst, src, sx0, sy0, x0, y0, x1, y1);
+      return;
+    }
+
+    if (src.masked) {
+      for (int y = y0; y < y1; y++) {
+        const Color *s = src.row(y - sy0) + (x0 - sx0);
+        if (src.translucent)
+          blendRow(dst, y, x0, x1, s);
+        else
+          maskedRow(dst, y, x0, x1, s);
+      }
+      return;
+    }
+
+    for (int y = y0; y < y1; y++) {
+      int sy = y - sy0;
+      const Color *s = src.row(sy);
+      for (int i = src.row_spans[sy]; i < src.row_spans[sy + 1]; i++) {
+        int from = std::max(sx0 + src.spans[i].start, x0);
+        int to = std::min(sx0 + src.spans[i].start + src.spans[i].len, x1);
+        if (from >= to) continue;
+        if (src.translucent)
+          blendRow(dst, y, from, to, s + (from - sx0));
+        else
+          copyRow(dst, y, from, to, s + (from - sx0));
+      }
+    }
+  }
+
+  // Angles are snapped to 1/angle_steps of a turn, so turned sprites and
+  // their hit test masks can be cached per step
+  constexpr int angle_steps = 256;
+
+  inline int angleStep(float angle) {
+    const float turn = 2 * std::acos(-1.0f);
+    int step = std::lround(angle / turn * angle_steps) % angle_steps;
+    return step < 0 ? step + angle_steps : step;
+  }
+
+  // Maps screen pixels of a w x h sprite placed at (x0, y0) and turned
+  // counter-clockwise around its center back to sprite pixels, in 16.16
+  struct AffineMap {
+    Rect bounds; // every pixel it may touch
+    int w, h;
+    int32_t u0, v0; // sprite position of the center of pixel (bounds.x0, bounds.y0)
+    int32_t du_dx, dv_dx, du_dy, dv_dy;
+    float inv_du_dx, inv_dv_dx; // pixels per sprite pixel along a row, 0 if parallel
+
+    static AffineMap rotated(int x0, int y0, int w, int h, int step) {
+      const float angle = step * 2 * std::acos(-1.0f) / angle_steps;
+      float c = std::cos(angle), s = std::sin(angle);
+      float cx = x0 + w * 0.5f, cy = y0 + h * 0.5f;
+      float ex = (std::abs(c) * w + std::abs(s) * h) / 2;
+      float ey = (std::abs(s) * w + std::abs(c) * h) / 2;
+      auto fixed = [](float f) { return (int32_t)std::lround(f * 65536); };
+
+      AffineMap m;
+      m.bounds = Rect{(int)std::floor(cx - ex), (int)std::floor(cy - ey), (int)std::ceil(cx + ex), (int)std::ceil(cy + ey)};
+      m.w = w, m.h = h;
+      // Screen y points down, so counter-clockwise on screen is clockwise in
+      // sprite coordinates
+      float dx = m.bounds.x0 + 0.5f - cx, dy = m.bounds.y0 + 0.5f - cy;
+      m.u0 = fixed(c * dx - s * dy + w * 0.5f);
+      m.v0 = fixed(s * dx + c * dy + h * 0.5f);
+      m.du_dx = fixed(c), m.dv_dx = fixed(s);
+      m.du_dy = fixed(-s), m.dv_dy = fixed(c);
+      m.inv_du_dx = m.du_dx ? 65536.0f / m.du_dx : 0;
+      m.inv_dv_dx = m.dv_dx ? 65536.0f / m.dv_dx : 0;
+      return m;
+    }
+
+    // Columns [x0, x1) of row y that may land inside the sprite, a pixel of
+    // slack on both ends
+    void span(int y, int &x0, int &x1) const {
+      float u = (u0 + (y - bounds.y0) * du_dy) / 65536.0f;
+      float v = (v0 + (y - bounds.y0) * dv_dy) / 65536.0f;
+      float lo = bounds.x0, hi = bounds.x1;
+      // Where 0 <= p + t * dp < size holds for t = x - bounds.x0
+      auto limit = [&](float p, float inv_dp, int size) {
+        if (inv_dp == 0) {
+          if (p < 0 || p >= size) hi = lo;
+          return;
+        }
+        float a = -p * inv_dp, b = (size - p) * inv_dp;
+        lo = std::max(lo, bounds.x0 + std::min(a, b) - 1);
+        hi = std::min(hi, bounds.x0 + std::max(a, b) + 1);
+      };
+      limit(u, inv_du_dx, w);
+      limit(v, inv_dv_dx, h);
+      x0 = std::floor(lo), x1 = std::max(x0, (int)std::ceil(hi));
+    }
+
+    // Pixels [x0, x1) of row y sampled from src, transparent outside of it
+    void row(const Sprite &src, int y, int x0, int x1, Color *out) const {
+      int32_t u = u0 + (x0 - bounds.x0) * du_dx + (y - bounds.y0) * du_dy;
+      int32_t v = v0 + (x0 - bounds.x0) * dv_dx + (y - bounds.y0) * dv_dy;
+      // Locals, Color stores could alias anything
+      const int32_t du = du_dx, dv = dv_dx;
+      const unsigned sw = w, sh = h;
+      const uint32_t *pixels = reinterpret_cast<const uint32_t *>(src.row(0));
+      uint32_t *dst = reinterpret_cast<uint32_t *>(out);
+      const uint32_t transparent = 0;
+
+      // u and v are linear along the row, so the pixels inside the sprite
+      // are one run: trim the outside ones off both ends, then sample the
+      // rest without bounds checks
+      auto inside = [&](int i) {
+        return unsigned((u + i * du) >> 16) < sw && unsigned((v + i * dv) >> 16) < sh;
+      };
+      int a = 0, b = x1 - x0;
+      while (a < b && !inside(a)) dst[a++] = transparent;
+      while (b > a && !inside(b - 1)) dst[--b] = transparent;
+      u += a * du, v += a * dv;
+      int i = a;
+#ifdef __SSE2__
+      // Four sprite offsets at a time: integer parts of u and v packed into
+      // 16-bit halves, then u + v * width with one madd
+      __m128i uu = _mm_setr_epi32(u, u + du, u + 2 * du, u + 3 * du);
+      __m128i vv = _mm_setr_epi32(v, v + dv, v + 2 * dv, v + 3 * dv);
+      const __m128i du4 = _mm_set1_epi32(4 * du), dv4 = _mm_set1_epi32(4 * dv);
+      const __m128i high = _mm_set1_epi32(0xffff0000);
+      const __m128i stride = _mm_set1_epi32(sw << 16 | 1);
+      alignas(16) int32_t offsets[4];
+      for (; i + 4 <= b; i += 4) {
+        __m128i uv = _mm_or_si128(_mm_srli_epi32(uu, 16), _mm_and_si128(vv, high));
+        _mm_store_si128((__m128i *)offsets, _mm_madd_epi16(uv, stride));
+        dst[i] = pixels[offsets[0]];
+        dst[i + 1] = pixels[offsets[1]];
+        dst[i + 2] = pixels[offsets[2]];
+        dst[i + 3] = pixels[offsets[3]];
+        uu = _mm_add_epi32(uu, du4), vv = _mm_add_epi32(vv, dv4);
+      }
+      u += (i - a) * du, v += (i - a) * dv;
+#endif
+      for (; i < b; i++, u += du, v += dv)
+        dst[i] = pixels[(v >> 16) * sw + (u >> 16)];
+    }
+  };
+
+  // Draws the sprite stretched to w x h at (x0, y0), turned counter-clockwise
+  // on screen by `angle` around its center
+  inline void sprite(const Surface &s, int x0, int y0, int w, int h, const Sprite &sprite,
+                     Filter filter = Filter::Nearest, float angle = 0) {
+    if (sprite.empty() || w <= 0 || h <= 0) return;
+    const Rect &clip = s.clip;
+
+    if (int step = angleStep(angle)) {
+      Rect b = AffineMap::rotated(x0, y0, w, h, step).bounds;
+      Rect c = b.intersect(clip);
+      if (!c.empty())
+        blit(s, *scaled(sprite, w, h, filter, step), b.x0, b.y0, c.x0, c.y0, c.x1, c.y1);
+      return;
+    }
+
+    int cx0 = std::max(x0, clip.x0), cx1 = std::min(x0 + w, clip.x1);
+    int cy0 = std::max(y0, clip.y0), cy1 = std::min(y0 + h, clip.y1);
+    if (cx0 >= cx1 || cy0 >= cy1) return;
+
+    if (w == sprite.width() && h == sprite.height())
+      blit(s, sprite, x0, y0, cx0, cy0, cx1, cy1);
+    else
+      blit(s, *scaled(sprite, w, h, filter), x0, y0, cx0, cy0, cx1, cy1);
   }
 
   enum class TextAlign {LEFT, CENTER, RIGHT};
 
-  inline void text(int x0, int y0, std::string s, TextAlign align = TextAlign::LEFT) {
+  // Left edge of the text once aligned
+  inline int alignText(int x0, std::string_view s, TextAlign align) {
     if (align != TextAlign::LEFT) {
       // I'm too lazy to align multiline strings
-      assert(s.find('\n') == std::string::npos);
+      assert(s.find('\n') == std::string_view::npos);
     }
 
     if (align == TextAlign::CENTER) {
@@ -137,6 +820,86 @@ namespace display {
     } else if (align == TextAlign::RIGHT) {
       x0 -= s.size() * sprites::font_size;
     }
+    return x0;
+  }
+
+  inline Rect textBounds(int x0, int y0, std::string_view s, TextAlign align = TextAlign::LEFT) {
+    x0 = alignText(x0, s, align);
+    int lines = 1, columns = 0, line = 0;
+    for (char c : s) {
+      if (c == '\n')
+        lines++, line = 0;
+      else
+        columns = std::max(columns, ++line);
+    }
+    return Rect{x0, y0, x0 + columns * sprites::font_size, y0 + lines * sprites::font_size};
+  }
+
+  // Pixels [x0, x0 + n) of row y to color where bit i of bits is set, n <= 32
+  inline void bitsRow(const Surface &s, int y, int x0, int n, uint32_t bits, Color color) {
+    int i = 0;
+    if (s.indices) {
+      uint8_t c = palette().index(color);
+      uint8_t *row = s.indexRow(y) + x0;
+#ifdef __SSE2__
+      // Byte k of the mask is set if bit k of the 16 is
+      const __m128i lanes = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+      const __m128i cv = _mm_set1_epi8(c);
+      for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_unpacklo_epi64(_mm_set1_epi8(bits >> i & 0xff), _mm_set1_epi8(bits >> (i + 8) & 0xff));
+        __m128i m = _mm_cmpeq_epi8(_mm_and_si128(b, lanes), lanes);
+        __m128i d = _mm_loadu_si128((const __m128i *)(row + i));
+        _mm_storeu_si128((__m128i *)(row + i), _mm_or_si128(_mm_and_si128(m, cv), _mm_andnot_si128(m, d)));
+      }
+#endif
+      for (; i < n; i++)
+        if (bits >> i & 1)
+          row[i] = c;
+      return;
+    }
+
+    uint32_t c = reinterpret_cast<uint32_t &>(color);
+    bool opaque = color.a == 255;
+    uint32_t *row = s.row(y) + x0;
+#ifdef __SSE2__
+    const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i cv = _mm_set1_epi32(c);
+    for (; i + 4 <= n; i += 4) {
+      uint32_t nibble = bits >> i & 0xf;
+      if (!nibble) continue;
+      __m128i m = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(nibble), lanes), lanes);
+      __m128i d = _mm_loadu_si128((const __m128i *)(row + i));
+      __m128i p = opaque ? cv : over4(cv, d);
+      _mm_storeu_si128((__m128i *)(row + i), _mm_or_si128(_mm_and_si128(m, p), _mm_andnot_si128(m, d)));
+    }
+#endif
+    for (; i < n; i++)
+      if (bits >> i & 1)
+        row[i] = opaque ? c : over(c, row[i]);
+  }
+
+  // The set pixels of the glyph at (x0, y0) in one color
+  inline void glyph(const Surface &s, int x0, int y0, const Glyph &g, Color color) {
+    constexpr int size = sprites::font_size;
+    static_assert(size == 32, "glyph rows are 32 bits");
+    const Rect &clip = s.clip;
+    int cx0 = std::max(x0, clip.x0), cx1 = std::min(x0 + size, clip.x1);
+    int cy0 = std::max(y0, clip.y0), cy1 = std::min(y0 + size, clip.y1);
+    if (cx0 >= cx1 || cy0 >= cy1 || color.a == 0) return;
+
+    uint32_t visible = uint32_t(bitRange(cx0 - x0, cx1 - x0));
+    for (int y = cy0; y < cy1; y++) {
+      uint32_t bits = (g.rows[y - y0] & visible) >> (cx0 - x0);
+      if (!bits) continue;
+      forUncovered(s, y, cx0, cx1, color.a == 255 ? bits : 0, [&](int from, int to) {
+        bitsRow(s, y, from, to - from, bits >> (from - cx0), color);
+      });
+    }
+  }
+
+  inline void text(const Surface &dst, int x0, int y0, std::string_view s, TextAlign align = TextAlign::LEFT,
+                   Color color = colors::white) {
+    x0 = alignText(x0, s, align);
 
     int x = x0, y = y0;
 
@@ -145,7 +908,7 @@ namespace display {
         y += sprites::font_size;
         x = x0;
       } else {
-        sprite(x, y, sprites::font_size, sprites::font_size, sprites::ascii[c]);
+        glyph(dst, x, y, sprites::ascii[c], color);
         x += sprites::font_size;
       }
     }
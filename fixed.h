@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "geometry.h"
+
+// Position on the wrapped world stored as 32-bit fractions of the world size
+// along each axis. Wrapping around the world is plain unsigned overflow and
+// integer arithmetic is the same on every compiler, so replays stay exact.
+struct FixedPos {
+  uint32_t x = 0, y = 0;
+
+  static constexpr double one = 4294967296.0; // 2^32, a full world size
+
+  // Signed offset, always the shortest way around (minimum image)
+  struct Delta {
+    int32_t x, y;
+
+    static Delta fromVec(Vec d, Vec size) {
+      return {toFixed(d.x / size.x), toFixed(d.y / size.y)};
+    }
+
+    Vec toVec(Vec size) const {
+      return {float(x * (size.x / one)), float(y * (size.y / one))};
+    }
+  };
+
+  static FixedPos fromVec(Vec v, Vec size) {
+    return {uint32_t(toFixed(v.x / size.x)), uint32_t(toFixed(v.y / size.y))};
+  }
+
+  Vec toVec(Vec size) const {
+    // The last fractions of a world round up to the world size as floats
+    auto below = [](uint32_t v, float size) {
+      return std::min(float(v) * (size / float(one)), size * (1 - 1.0f / (1 << 24)));
+    };
+    return {below(x, size.x), below(y, size.y)};
+  }
+
+  FixedPos &operator+=(Delta d) {
+    x += uint32_t(d.x), y += uint32_t(d.y);
+    return *this;
+  }
+
+  friend Delta operator-(FixedPos a, FixedPos b) {
+    return {int32_t(a.x - b.x), int32_t(a.y - b.y)};
+  }
+
+private:
+  // Fraction of the world to fixed point, wrapped modulo one world
+  static int32_t toFixed(double frac) {
+    return int32_t(uint32_t(int64_t(std::llround((frac - std::floor(frac)) * one))));
+  }
+};
@@ -7,10 +7,8 @@
 
 namespace display {
 
-Color fg = {255, 255, 255};
-
-Sprite sprites::ascii[128] = {
-  Sprite::fromString( // ascii 0
+constexpr Glyph sprites::ascii[128] = {
+  Glyph::fromString( // ascii 0
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -43,8 +41,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 1
+  ),
+  Glyph::fromString( // ascii 1
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -77,8 +75,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 2
+  ),
+  Glyph::fromString( // ascii 2
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -111,8 +109,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 3
+  ),
+  Glyph::fromString( // ascii 3
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -145,8 +143,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 4
+  ),
+  Glyph::fromString( // ascii 4
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -179,8 +177,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 5
+  ),
+  Glyph::fromString( // ascii 5
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -213,8 +211,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 6
+  ),
+  Glyph::fromString( // ascii 6
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -247,8 +245,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 7
+  ),
+  Glyph::fromString( // ascii 7
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -281,8 +279,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 8
+  ),
+  Glyph::fromString( // ascii 8
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -315,8 +313,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 9
+  ),
+  Glyph::fromString( // ascii 9
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -349,8 +347,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 10
+  ),
+  Glyph::fromString( // ascii 10
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -383,8 +381,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 11
+  ),
+  Glyph::fromString( // ascii 11
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -417,8 +415,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 12
+  ),
+  Glyph::fromString( // ascii 12
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -451,8 +449,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 13
+  ),
+  Glyph::fromString( // ascii 13
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -485,8 +483,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 14
+  ),
+  Glyph::fromString( // ascii 14
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -519,8 +517,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 15
+  ),
+  Glyph::fromString( // ascii 15
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -553,8 +551,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 16
+  ),
+  Glyph::fromString( // ascii 16
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -587,8 +585,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 17
+  ),
+  Glyph::fromString( // ascii 17
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -621,8 +619,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 18
+  ),
+  Glyph::fromString( // ascii 18
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -655,8 +653,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 19
+  ),
+  Glyph::fromString( // ascii 19
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -689,8 +687,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 20
+  ),
+  Glyph::fromString( // ascii 20
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -723,8 +721,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 21
+  ),
+  Glyph::fromString( // ascii 21
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -757,8 +755,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 22
+  ),
+  Glyph::fromString( // ascii 22
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -791,8 +789,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 23
+  ),
+  Glyph::fromString( // ascii 23
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -825,8 +823,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 24
+  ),
+  Glyph::fromString( // ascii 24
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -859,8 +857,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 25
+  ),
+  Glyph::fromString( // ascii 25
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -893,8 +891,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 26
+  ),
+  Glyph::fromString( // ascii 26
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -927,8 +925,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 27
+  ),
+  Glyph::fromString( // ascii 27
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -961,8 +959,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 28
+  ),
+  Glyph::fromString( // ascii 28
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -995,8 +993,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 29
+  ),
+  Glyph::fromString( // ascii 29
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -1029,8 +1027,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 30
+  ),
+  Glyph::fromString( // ascii 30
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -1063,8 +1061,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 31
+  ),
+  Glyph::fromString( // ascii 31
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -1097,8 +1095,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 32
+  ),
+  Glyph::fromString( // ascii 32
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1131,8 +1129,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 33
+  ),
+  Glyph::fromString( // ascii 33
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1165,8 +1163,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 34
+  ),
+  Glyph::fromString( // ascii 34
   "........0000....0000............\n"
   "........0000....0000............\n"
   "........0000....0000............\n"
@@ -1199,8 +1197,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 35
+  ),
+  Glyph::fromString( // ascii 35
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1233,8 +1231,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 36
+  ),
+  Glyph::fromString( // ascii 36
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1267,8 +1265,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 37
+  ),
+  Glyph::fromString( // ascii 37
   "....00000000....................\n"
   "....00000000....................\n"
   "....00000000....................\n"
@@ -1301,8 +1299,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 38
+  ),
+  Glyph::fromString( // ascii 38
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -1335,8 +1333,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 39
+  ),
+  Glyph::fromString( // ascii 39
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1369,8 +1367,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 40
+  ),
+  Glyph::fromString( // ascii 40
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1403,8 +1401,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 41
+  ),
+  Glyph::fromString( // ascii 41
   "............0000................\n"
   "............0000................\n"
   "............0000................\n"
@@ -1437,8 +1435,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 42
+  ),
+  Glyph::fromString( // ascii 42
   "........0000....0000....0000....\n"
   "........0000....0000....0000....\n"
   "........0000....0000....0000....\n"
@@ -1471,8 +1469,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 43
+  ),
+  Glyph::fromString( // ascii 43
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1505,8 +1503,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 44
+  ),
+  Glyph::fromString( // ascii 44
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1539,8 +1537,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 45
+  ),
+  Glyph::fromString( // ascii 45
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1573,8 +1571,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 46
+  ),
+  Glyph::fromString( // ascii 46
   "................................\n"
   "................................\n"
   "................................\n"
@@ -1607,8 +1605,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 47
+  ),
+  Glyph::fromString( // ascii 47
   "........................0000....\n"
   "........................0000....\n"
   "........................0000....\n"
@@ -1641,8 +1639,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 48
+  ),
+  Glyph::fromString( // ascii 48
   "............00000000............\n"
   "............00000000............\n"
   "............00000000............\n"
@@ -1675,8 +1673,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 49
+  ),
+  Glyph::fromString( // ascii 49
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1709,8 +1707,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 50
+  ),
+  Glyph::fromString( // ascii 50
   "........0000000000000000........\n"
   "........0000000000000000........\n"
   "........0000000000000000........\n"
@@ -1743,8 +1741,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 51
+  ),
+  Glyph::fromString( // ascii 51
   "........0000000000000000........\n"
   "........0000000000000000........\n"
   "........0000000000000000........\n"
@@ -1777,8 +1775,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 52
+  ),
+  Glyph::fromString( // ascii 52
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -1811,8 +1809,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 53
+  ),
+  Glyph::fromString( // ascii 53
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -1845,8 +1843,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 54
+  ),
+  Glyph::fromString( // ascii 54
   "........0000000000000000........\n"
   "........0000000000000000........\n"
   "........0000000000000000........\n"
@@ -1879,8 +1877,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 55
+  ),
+  Glyph::fromString( // ascii 55
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -1913,8 +1911,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 56
+  ),
+  Glyph::fromString( // ascii 56
   "........0000000000000000........\n"
   "........0000000000000000........\n"
   "........0000000000000000........\n"
@@ -1947,8 +1945,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 57
+  ),
+  Glyph::fromString( // ascii 57
   "........0000000000000000........\n"
   "........0000000000000000........\n"
   "........0000000000000000........\n"
@@ -1981,8 +1979,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 58
+  ),
+  Glyph::fromString( // ascii 58
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2015,8 +2013,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 59
+  ),
+  Glyph::fromString( // ascii 59
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2049,8 +2047,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 60
+  ),
+  Glyph::fromString( // ascii 60
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2083,8 +2081,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 61
+  ),
+  Glyph::fromString( // ascii 61
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2117,8 +2115,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 62
+  ),
+  Glyph::fromString( // ascii 62
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2151,8 +2149,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 63
+  ),
+  Glyph::fromString( // ascii 63
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -2185,8 +2183,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 64
+  ),
+  Glyph::fromString( // ascii 64
   "................................\n"
   "................................\n"
   "................................\n"
@@ -2219,8 +2217,8 @@ Sprite sprites::ascii[128] = {
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
-  , {fg}),
-  Sprite::fromString( // ascii 65
+  ),
+  Glyph::fromString( // ascii 65
   "............00000000............\n"
   "............00000000............\n"
   "............00000000............\n"
@@ -2253,8 +2251,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 66
+  ),
+  Glyph::fromString( // ascii 66
   "....0000000000000000............\n"
   "....0000000000000000............\n"
   "....0000000000000000............\n"
@@ -2287,8 +2285,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 67
+  ),
+  Glyph::fromString( // ascii 67
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -2321,8 +2319,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 68
+  ),
+  Glyph::fromString( // ascii 68
   "....0000000000000000............\n"
   "....0000000000000000............\n"
   "....0000000000000000............\n"
@@ -2355,8 +2353,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 69
+  ),
+  Glyph::fromString( // ascii 69
   "....00000000000000000000........\n"
   "....00000000000000000000........\n"
   "....00000000000000000000........\n"
@@ -2389,8 +2387,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 70
+  ),
+  Glyph::fromString( // ascii 70
   "....00000000000000000000........\n"
   "....00000000000000000000........\n"
   "....00000000000000000000........\n"
@@ -2423,8 +2421,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 71
+  ),
+  Glyph::fromString( // ascii 71
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -2457,8 +2455,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 72
+  ),
+  Glyph::fromString( // ascii 72
   "....0000................0000....\n"
   "....0000................0000....\n"
   "....0000................0000....\n"
@@ -2491,8 +2489,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 73
+  ),
+  Glyph::fromString( // ascii 73
   "........00000000000000000000....\n"
   "........00000000000000000000....\n"
   "........00000000000000000000....\n"
@@ -2525,8 +2523,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 74
+  ),
+  Glyph::fromString( // ascii 74
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -2559,8 +2557,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 75
+  ),
+  Glyph::fromString( // ascii 75
   "....0000............0000........\n"
   "....0000............0000........\n"
   "....0000............0000........\n"
@@ -2593,8 +2591,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 76
+  ),
+  Glyph::fromString( // ascii 76
   "....0000........................\n"
   "....0000........................\n"
   "....0000........................\n"
@@ -2627,8 +2625,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 77
+  ),
+  Glyph::fromString( // ascii 77
   "....0000....................0000\n"
   "....0000....................0000\n"
   "....0000....................0000\n"
@@ -2661,8 +2659,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 78
+  ),
+  Glyph::fromString( // ascii 78
   "....0000................0000....\n"
   "....0000................0000....\n"
   "....0000................0000....\n"
@@ -2695,8 +2693,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 79
+  ),
+  Glyph::fromString( // ascii 79
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -2729,8 +2727,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 80
+  ),
+  Glyph::fromString( // ascii 80
   "....0000000000000000............\n"
   "....0000000000000000............\n"
   "....0000000000000000............\n"
@@ -2763,8 +2761,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 81
+  ),
+  Glyph::fromString( // ascii 81
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -2797,8 +2795,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 82
+  ),
+  Glyph::fromString( // ascii 82
   "....0000000000000000............\n"
   "....0000000000000000............\n"
   "....0000000000000000............\n"
@@ -2831,8 +2829,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 83
+  ),
+  Glyph::fromString( // ascii 83
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -2865,8 +2863,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 84
+  ),
+  Glyph::fromString( // ascii 84
   "....0000000000000000000000000000\n"
   "....0000000000000000000000000000\n"
   "....0000000000000000000000000000\n"
@@ -2899,8 +2897,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 85
+  ),
+  Glyph::fromString( // ascii 85
   "....0000................0000....\n"
   "....0000................0000....\n"
   "....0000................0000....\n"
@@ -2933,8 +2931,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 86
+  ),
+  Glyph::fromString( // ascii 86
   "0000........................0000\n"
   "0000........................0000\n"
   "0000........................0000\n"
@@ -2967,8 +2965,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 87
+  ),
+  Glyph::fromString( // ascii 87
   "....0000....................0000\n"
   "....0000....................0000\n"
   "....0000....................0000\n"
@@ -3001,8 +2999,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 88
+  ),
+  Glyph::fromString( // ascii 88
   "....0000................0000....\n"
   "....0000................0000....\n"
   "....0000................0000....\n"
@@ -3035,8 +3033,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 89
+  ),
+  Glyph::fromString( // ascii 89
   "....0000....................0000\n"
   "....0000....................0000\n"
   "....0000....................0000\n"
@@ -3069,8 +3067,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 90
+  ),
+  Glyph::fromString( // ascii 90
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -3103,8 +3101,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 91
+  ),
+  Glyph::fromString( // ascii 91
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -3137,8 +3135,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 92
+  ),
+  Glyph::fromString( // ascii 92
   "....0000........................\n"
   "....0000........................\n"
   "....0000........................\n"
@@ -3171,8 +3169,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 93
+  ),
+  Glyph::fromString( // ascii 93
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -3205,8 +3203,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 94
+  ),
+  Glyph::fromString( // ascii 94
   "............0000................\n"
   "............0000................\n"
   "............0000................\n"
@@ -3239,8 +3237,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 95
+  ),
+  Glyph::fromString( // ascii 95
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3273,8 +3271,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 96
+  ),
+  Glyph::fromString( // ascii 96
   "............0000................\n"
   "............0000................\n"
   "............0000................\n"
@@ -3307,8 +3305,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 97
+  ),
+  Glyph::fromString( // ascii 97
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3341,8 +3339,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 98
+  ),
+  Glyph::fromString( // ascii 98
   "....0000........................\n"
   "....0000........................\n"
   "....0000........................\n"
@@ -3375,8 +3373,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 99
+  ),
+  Glyph::fromString( // ascii 99
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3409,8 +3407,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 100
+  ),
+  Glyph::fromString( // ascii 100
   "........................0000....\n"
   "........................0000....\n"
   "........................0000....\n"
@@ -3443,8 +3441,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 101
+  ),
+  Glyph::fromString( // ascii 101
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3477,8 +3475,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 102
+  ),
+  Glyph::fromString( // ascii 102
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3511,8 +3509,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 103
+  ),
+  Glyph::fromString( // ascii 103
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3545,8 +3543,8 @@ Sprite sprites::ascii[128] = {
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
-  , {fg}),
-  Sprite::fromString( // ascii 104
+  ),
+  Glyph::fromString( // ascii 104
   "........0000....................\n"
   "........0000....................\n"
   "........0000....................\n"
@@ -3579,8 +3577,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 105
+  ),
+  Glyph::fromString( // ascii 105
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -3613,8 +3611,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 106
+  ),
+  Glyph::fromString( // ascii 106
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -3647,8 +3645,8 @@ Sprite sprites::ascii[128] = {
   "....000000000000................\n"
   "....000000000000................\n"
   "....000000000000................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 107
+  ),
+  Glyph::fromString( // ascii 107
   "........0000....................\n"
   "........0000....................\n"
   "........0000....................\n"
@@ -3681,8 +3679,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 108
+  ),
+  Glyph::fromString( // ascii 108
   "............0000................\n"
   "............0000................\n"
   "............0000................\n"
@@ -3715,8 +3713,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 109
+  ),
+  Glyph::fromString( // ascii 109
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3749,8 +3747,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 110
+  ),
+  Glyph::fromString( // ascii 110
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3783,8 +3781,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 111
+  ),
+  Glyph::fromString( // ascii 111
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3817,8 +3815,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 112
+  ),
+  Glyph::fromString( // ascii 112
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3851,8 +3849,8 @@ Sprite sprites::ascii[128] = {
   "....0000........................\n"
   "....0000........................\n"
   "....0000........................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 113
+  ),
+  Glyph::fromString( // ascii 113
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3885,8 +3883,8 @@ Sprite sprites::ascii[128] = {
   "........................0000....\n"
   "........................0000....\n"
   "........................0000....\n"
-  , {fg}),
-  Sprite::fromString( // ascii 114
+  ),
+  Glyph::fromString( // ascii 114
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3919,8 +3917,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 115
+  ),
+  Glyph::fromString( // ascii 115
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3953,8 +3951,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 116
+  ),
+  Glyph::fromString( // ascii 116
   "................................\n"
   "................................\n"
   "................................\n"
@@ -3987,8 +3985,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 117
+  ),
+  Glyph::fromString( // ascii 117
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4021,8 +4019,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 118
+  ),
+  Glyph::fromString( // ascii 118
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4055,8 +4053,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 119
+  ),
+  Glyph::fromString( // ascii 119
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4089,8 +4087,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 120
+  ),
+  Glyph::fromString( // ascii 120
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4123,8 +4121,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 121
+  ),
+  Glyph::fromString( // ascii 121
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4157,8 +4155,8 @@ Sprite sprites::ascii[128] = {
   "....00000000....................\n"
   "....00000000....................\n"
   "....00000000....................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 122
+  ),
+  Glyph::fromString( // ascii 122
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4191,8 +4189,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 123
+  ),
+  Glyph::fromString( // ascii 123
   "............000000000000........\n"
   "............000000000000........\n"
   "............000000000000........\n"
@@ -4225,8 +4223,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 124
+  ),
+  Glyph::fromString( // ascii 124
   "................0000............\n"
   "................0000............\n"
   "................0000............\n"
@@ -4259,8 +4257,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 125
+  ),
+  Glyph::fromString( // ascii 125
   "........000000000000............\n"
   "........000000000000............\n"
   "........000000000000............\n"
@@ -4293,8 +4291,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 126
+  ),
+  Glyph::fromString( // ascii 126
   "................................\n"
   "................................\n"
   "................................\n"
@@ -4327,8 +4325,8 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
-  Sprite::fromString( // ascii 127
+  ),
+  Glyph::fromString( // ascii 127
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
   "....000000000000000000000000....\n"
@@ -4361,6 +4359,6 @@ Sprite sprites::ascii[128] = {
   "................................\n"
   "................................\n"
   "................................\n"
-  , {fg}),
+  ),
 };
 }
@@ -0,0 +1,275 @@
+#include "layers.h"
+
+#include <chrono>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace display {
+
+void ResolutionGovernor::update(float ms) {
+  average_ms = average_ms ? average_ms + (ms - average_ms) * 0.1f : ms;
+  if (hold > 0) {
+    hold--;
+    return;
+  }
+  // A level up costs at most (5 / 4)^2 = 1.56 times as much, so from below
+  // 0.6 of the budget it does not bounce right back
+  if (average_ms > budget_ms && level > min_level)
+    level--, hold = settle_frames;
+  else if (average_ms < budget_ms * 0.6f && level < max_level)
+    level++, hold = settle_frames;
+}
+
+namespace {
+  constexpr int steps = ResolutionGovernor::steps;
+
+  // Nearest source pixel of pixel j in a group of `steps` screen pixels,
+  // the group coming from n source pixels
+  constexpr int upscaleTap(int n, int j) {
+    return (2 * j + 1) * n / (2 * steps);
+  }
+
+#ifdef __SSE2__
+  // Lanes i0..i3 of the 8 in a and b
+  template <int i0, int i1, int i2, int i3>
+  inline __m128i pick4(__m128i a, __m128i b) {
+    __m128 fa = _mm_castsi128_ps(a), fb = _mm_castsi128_ps(b);
+    __m128 lo = _mm_shuffle_ps(i0 < 4 ? fa : fb, i1 < 4 ? fa : fb, _MM_SHUFFLE(i1 % 4, i1 % 4, i0 % 4, i0 % 4));
+    __m128 hi = _mm_shuffle_ps(i2 < 4 ? fa : fb, i3 < 4 ? fa : fb, _MM_SHUFFLE(i3 % 4, i3 % 4, i2 % 4, i2 % 4));
+    return _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+#endif
+
+  // Screen pixels [steps * g0, steps * g1) of a row from a row n / steps the
+  // size, nearest neighbour. Reads up to 8 pixels past each group's source.
+  template <int n>
+  void upscaleGroups(const uint32_t *src, int g0, int g1, uint32_t *out) {
+    static_assert(steps == 8, "one group is two vectors");
+    for (int g = g0; g < g1; g++, out += steps) {
+      const uint32_t *s = src + g * n;
+#ifdef __SSE2__
+      __m128i a = _mm_loadu_si128((const __m128i *)s);
+      __m128i b = _mm_loadu_si128((const __m128i *)(s + 4));
+      _mm_storeu_si128((__m128i *)out,
+        pick4<upscaleTap(n, 0), upscaleTap(n, 1), upscaleTap(n, 2), upscaleTap(n, 3)>(a, b));
+      _mm_storeu_si128((__m128i *)(out + 4),
+        pick4<upscaleTap(n, 4), upscaleTap(n, 5), upscaleTap(n, 6), upscaleTap(n, 7)>(a, b));
+#else
+      for (int j = 0; j < steps; j++)
+        out[j] = s[upscaleTap(n, j)];
+#endif
+    }
+  }
+
+  // Screen columns [x0, x1) of a row of a surface level / steps the size of
+  // the screen. out[0] is column x0 rounded down to a group.
+  void upscaleRow(const uint32_t *src, int level, int x0, int x1, uint32_t *out) {
+    int g0 = x0 / steps, g1 = (x1 + steps - 1) / steps;
+    switch (level) {
+      case 4: upscaleGroups<4>(src, g0, g1, out); break;
+      case 5: upscaleGroups<5>(src, g0, g1, out); break;
+      case 6: upscaleGroups<6>(src, g0, g1, out); break;
+      case 7: upscaleGroups<7>(src, g0, g1, out); break;
+      default: std::copy(src + g0 * steps, src + g1 * steps, out);
+    }
+  }
+
+  // All of the first n indices are 0, transparent
+  bool transparentRow(const uint8_t *indices, int n) {
+    int x = 0;
+#ifdef __SSE2__
+    __m128i any = _mm_setzero_si128();
+    for (; x + 16 <= n; x += 16)
+      any = _mm_or_si128(any, _mm_loadu_si128((const __m128i *)(indices + x)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff)
+      return false;
+#endif
+    for (; x < n; x++)
+      if (indices[x]) return false;
+    return true;
+  }
+
+  static_assert(ResolutionGovernor::min_level == 4 && ResolutionGovernor::max_level == 8,
+                "upscaleRow has a case for every level");
+  static_assert(SCREEN_WIDTH % steps == 0 && SCREEN_HEIGHT % steps == 0,
+                "every level has a whole number of pixels");
+}
+
+LayeredRenderer::LayeredRenderer() {
+  for (int i = 0; i < layer_count; i++) {
+    LayerData &layer = layers[i];
+    if (i == Hud) {
+      // Sprites and text in a few colors, a byte a pixel is plenty
+      layer.indices.reset(new uint8_t[SCREEN_HEIGHT][SCREEN_WIDTH]);
+      layer.renderer.surface = Surface::indexed(&layer.indices[0][0], SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH);
+    } else {
+      layer.pixels.reset(new uint32_t[SCREEN_HEIGHT][SCREEN_WIDTH]);
+      layer.renderer.surface = Surface::of(&layer.pixels[0][0], SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH);
+    }
+  }
+  // Asteroids pile up, the other layers hardly overlap
+  layers[World].renderer.front_to_back = true;
+}
+
+void LayeredRenderer::clear() {
+  for (LayerData &layer : layers)
+    layer.cmds.clear();
+}
+
+void LayeredRenderer::render() {
+  auto start = std::chrono::steady_clock::now();
+
+  int level = dynamic_resolution ? governor.level : ResolutionGovernor::max_level;
+  if (level != world_level) {
+    world_level = level;
+    TileRenderer &world = layers[World].renderer;
+    world.surface = Surface::of(&layers[World].pixels[0][0], SCREEN_WIDTH * level / steps,
+                                SCREEN_HEIGHT * level / steps, SCREEN_WIDTH);
+    world.invalidate();
+  }
+
+  for (int i = 0; i < layer_count; i++) {
+    const CommandBuffer *cmds = &layers[i].cmds;
+    if (i == World && world_level != ResolutionGovernor::max_level) {
+      cmds->scaled((float)world_level / steps, scaled_world);
+      cmds = &scaled_world;
+    }
+    layers[i].renderer.render(*cmds, i == 0 ? opaque_black : transparent);
+  }
+
+  // Composited frames are kept and updated where something changed, but
+  // that frame moves when post-processing is turned on or off
+  bool everything = post.enabled() != post_used;
+  post_used = post.enabled();
+  workers().parallelFor(TileRenderer::tiles_x * TileRenderer::tiles_y, [&](int tile) {
+    Rect r = everything ? TileRenderer::tileRect(tile) : Rect{SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0};
+    bool blend[layer_count];
+    for (int i = 0; i < layer_count; i++) {
+      Rect d;
+      if (i == World && world_level != ResolutionGovernor::max_level) {
+        d = worldDamage(tile, blend[i]);
+      } else {
+        blend[i] = layers[i].renderer.tileTranslucent(tile);
+        d = layers[i].renderer.tileDamage(tile);
+      }
+      if (d.empty()) continue;
+      r = Rect{std::min(r.x0, d.x0), std::min(r.y0, d.y0), std::max(r.x1, d.x1), std::max(r.y1, d.y1)};
+    }
+    if (!r.empty())
+      composite(r, blend);
+  });
+
+  post.apply();
+
+  if (dynamic_resolution)
+    governor.update(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
+Rect LayeredRenderer::worldDamage(int tile, bool &translucent) const {
+  const TileRenderer &world = layers[World].renderer;
+  const int n = world_level, size = TileRenderer::tile_size;
+  // Screen pixel x shows world pixel (2x + 1) * n / 16, so screen columns
+  // [a, b) show world ones within [a * n / 8, b * n / 8) and the other way
+  // around, rounded outwards
+  auto toWorld = [&](int x, int round) { return (x * n + round * (steps - 1)) / steps; };
+  auto toScreen = [&](int x, int round) { return (x * steps + round * (n - 1)) / n; };
+
+  Rect t = TileRenderer::tileRect(tile), res{SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0};
+  translucent = false;
+  for (int ty = toWorld(t.y0, 0) / size; ty <= (toWorld(t.y1, 1) - 1) / size; ty++)
+  for (int tx = toWorld(t.x0, 0) / size; tx <= (toWorld(t.x1, 1) - 1) / size; tx++) {
+    int source = ty * TileRenderer::tiles_x + tx;
+    translucent |= world.tileTranslucent(source);
+    Rect d = world.tileDamage(source);
+    if (d.empty()) continue;
+    d = Rect{toScreen(d.x0, 0), toScreen(d.y0, 0), toScreen(d.x1, 1), toScreen(d.y1, 1)}.intersect(t);
+    if (d.empty()) continue;
+    res = Rect{std::min(res.x0, d.x0), std::min(res.y0, d.y0), std::max(res.x1, d.x1), std::max(res.y1, d.y1)};
+  }
+  return res;
+}
+
+void LayeredRenderer::composite(Rect r, const bool *blend) {
+  // World layer rows scaled up to the screen, r is within one tile
+  alignas(16) uint32_t world_row[TileRenderer::tile_size + 2 * steps];
+  int world_y = -1;
+  // Indexed layers turned into colors. SSE2 has no byte shuffles or
+  // gathers, so it is a plain table lookup; the table stays in L1. Mostly
+  // the rows are empty though, and share one transparent row.
+  uint32_t expanded[layer_count][TileRenderer::tile_size];
+  static const uint32_t none[TileRenderer::tile_size] = {};
+  const uint32_t *colors = palette().colors();
+
+  for (int y = r.y0; y < r.y1; y++) {
+    uint32_t *out = (post_used ? post.frameRow(y) : buffer[y]) + r.x0;
+    const uint32_t *src[layer_count];
+    for (int l = 0; l < layer_count; l++) {
+      if (layers[l].indices) {
+        const uint8_t *indices = &layers[l].indices[y][r.x0];
+        if (transparentRow(indices, r.x1 - r.x0)) {
+          src[l] = none;
+          continue;
+        }
+        for (int x = 0; x < r.x1 - r.x0; x++)
+          expanded[l][x] = colors[indices[x]];
+        src[l] = expanded[l];
+      } else {
+        src[l] = &layers[l].pixels[y][r.x0];
+      }
+    }
+
+    if (world_level != ResolutionGovernor::max_level) {
+      int sy = upscaleTap(world_level, y % steps) + y / steps * world_level;
+      if (sy != world_y)
+        upscaleRow(layers[World].pixels[sy], world_level, r.x0, r.x1, world_row);
+      world_y = sy;
+      src[World] = world_row + r.x0 % steps;
+    }
+
+    int n = r.x1 - r.x0, x = 0;
+    auto pixel = [&](int x) {
+      uint32_t p = src[0][x];
+      for (int l = 1; l < layer_count; l++)
+        p = over(src[l][x], p);
+      out[x] = p;
+    };
+
+#ifdef __SSE2__
+    // Streaming stores skip the cache, nobody reads the frame before it is
+    // shown or post-processed as a whole. They need 16 byte alignment.
+    for (; x < n && (uintptr_t)(out + x) % 16 != 0; x++)
+      pixel(x);
+
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    auto composite4 = [&](auto blends) {
+      for (; x + 4 <= n; x += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src[0] + x));
+        for (int l = 1; l < layer_count; l++) {
+          __m128i s = _mm_loadu_si128((const __m128i *)(src[l] + x));
+          if (blends(l)) {
+            p = over4(s, p);
+          } else {
+            // Only opaque or transparent pixels, over is a select
+            __m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha);
+            p = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, p));
+          }
+        }
+        _mm_stream_si128((__m128i *)(out + x), p);
+      }
+    };
+    if (std::any_of(blend + 1, blend + layer_count, [](bool b) { return b; }))
+      composite4([&](int l) { return blend[l]; });
+    else
+      composite4([](int) { return false; });
+#endif
+    for (; x < n; x++)
+      pixel(x);
+  }
+#ifdef __SSE2__
+  _mm_sfence();
+#endif
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+
+#include "display.h"
+#include "commands.h"
+#include "tiles.h"
+#include "postfx.h"
+
+namespace display {
+  // Picks a resolution from how long recent frames took: stepped down while
+  // their average is over the budget, back up once it is well below
+  struct ResolutionGovernor {
+    static constexpr int steps = 8; // the resolution is level / steps of the screen
+    static constexpr int min_level = 4, max_level = steps;
+    // Frames between changes, for the average to catch up with the new level
+    static constexpr int settle_frames = 30;
+
+    float budget_ms = 8;
+    int level = max_level;
+
+    // Call once a frame with the time it took
+    void update(float ms);
+
+  private:
+    float average_ms = 0;
+    int hold = settle_frames; // the first frames fill caches
+  };
+
+  // Frame split into layers, each recorded and drawn into a surface of its
+  // own. A layer whose commands did not change is not redrawn at all, and
+  // only the parts of the screen some layer changed are composited.
+  class LayeredRenderer {
+  public:
+    enum Layer { Background, World, Hud, layer_count };
+
+    LayeredRenderer();
+
+    CommandBuffer &operator[](Layer layer) { return layers[layer].cmds; }
+
+    // Forgets the recorded commands, call before recording a frame
+    void clear();
+
+    // Redraws changed layers, then composites into the backbuffer
+    void render();
+
+    // Draw the world layer at the resolution the governor picks from the
+    // time render() takes, scaled up to the screen when compositing
+    bool dynamic_resolution = false;
+    ResolutionGovernor governor;
+
+    // Applied on the way from the composited frame to the backbuffer
+    PostProcess post;
+
+  private:
+    struct LayerData {
+      std::unique_ptr<uint32_t[][SCREEN_WIDTH]> pixels;
+      std::unique_ptr<uint8_t[][SCREEN_WIDTH]> indices; // instead of pixels, for indexed layers
+      CommandBuffer cmds;
+      TileRenderer renderer;
+    };
+
+    // Bottom layer is opaque black, the rest starts out transparent
+    static constexpr uint32_t opaque_black = 0xff000000;
+    static constexpr uint32_t transparent = 0;
+
+    // Every layer over the one below into the backbuffer, or the frame of
+    // post when it is used. Layers without blend[layer] have no translucent
+    // pixels in r.
+    void composite(Rect r, const bool *blend);
+
+    // Part of the screen tile the world layer changed, and whether it may
+    // have translucent pixels there, when drawn below screen resolution
+    Rect worldDamage(int tile, bool &translucent) const;
+
+    LayerData layers[layer_count];
+    CommandBuffer scaled_world; // world commands at world_level
+    int world_level = ResolutionGovernor::max_level;
+    bool post_used = false; // the last frame was composited for post
+  };
+}
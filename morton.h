@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "geometry.h"
+
+// Z-order curve keys: sorting by them keeps things that are close in the
+// world mostly close in memory as well.
+
+// 0b...dcba -> 0b...0d0c0b0a for the low 16 bits
+inline uint32_t spreadBits(uint32_t x) {
+  x &= 0xffff;
+  x = (x | x << 8) & 0x00ff00ff;
+  x = (x | x << 4) & 0x0f0f0f0f;
+  x = (x | x << 2) & 0x33333333;
+  x = (x | x << 1) & 0x55555555;
+  return x;
+}
+
+// Position in [0, size) to a 32-bit key, 16 bits per axis
+inline uint32_t mortonKey(Vec pos, Vec size) {
+  auto cell = [](float frac) {
+    return (uint32_t)std::clamp(frac * 65536.0f, 0.0f, 65535.0f);
+  };
+  return spreadBits(cell(pos.x / size.x)) | spreadBits(cell(pos.y / size.y)) << 1;
+}
+
+// Sorts items by the Morton key of pos(item) and returns where every item came
+// from: perm[new_index] == old_index.
+template <class T, class GetPos>
+std::vector<int> sortByMorton(std::vector<T> &items, Vec size, GetPos &&pos) {
+  std::vector<std::pair<uint32_t, int>> keys(items.size());
+  for (size_t i = 0; i < items.size(); i++)
+    keys[i] = {mortonKey(pos(items[i]), size), (int)i};
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<int> perm(items.size());
+  std::vector<T> sorted;
+  sorted.reserve(items.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    perm[i] = keys[i].second;
+    sorted.push_back(std::move(items[perm[i]]));
+  }
+  items = std::move(sorted);
+  return perm;
+}
@@ -0,0 +1,194 @@
+#include "postfx.h"
+
+#include <cmath>
+
+#include "tiles.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace display {
+
+namespace {
+  // Binomial blur, in half resolution pixels
+  constexpr int radius = 4, taps = 2 * radius + 1;
+  constexpr uint16_t weights[taps] = {1, 8, 28, 56, 70, 56, 28, 8, 1}; // sum 256, symmetric
+
+  // Per channel (a + b + 1) / 2, like _mm_avg_epu8
+  inline uint32_t average(uint32_t a, uint32_t b) {
+    return (a | b) - ((a ^ b) >> 1 & 0x7f7f7f7f);
+  }
+
+  // Per channel a - b, 0 if negative
+  inline uint32_t subtract(uint32_t a, uint32_t b) {
+    uint32_t res = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      int c = int(a >> shift & 0xff) - int(b >> shift & 0xff);
+      res |= uint32_t(std::max(c, 0)) << shift;
+    }
+    return res;
+  }
+
+  // out[x] = sum of weights[k] * src[k][x] / 256 per channel, x < n
+  void blur(const uint32_t *const *src, int n, uint32_t *out) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 4 <= n; x += 4) {
+      // Symmetric, so taps k and taps - 1 - k are added before weighing
+      auto tap = [&](int k, __m128i &lo, __m128i &hi) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src[k] + x));
+        lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(p, zero));
+        hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(p, zero));
+      };
+      __m128i lo = zero, hi = zero;
+      for (int k = 0; k <= radius; k++) {
+        __m128i plo = zero, phi = zero;
+        tap(k, plo, phi);
+        if (k != radius)
+          tap(taps - 1 - k, plo, phi);
+        __m128i w = _mm_set1_epi16(weights[k]);
+        lo = _mm_add_epi16(lo, _mm_mullo_epi16(plo, w));
+        hi = _mm_add_epi16(hi, _mm_mullo_epi16(phi, w));
+      }
+      _mm_storeu_si128((__m128i *)(out + x), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+#endif
+    for (; x < n; x++) {
+      uint32_t res = 0;
+      for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++)
+          sum += weights[k] * (src[k][x] >> shift & 0xff);
+        res |= (sum >> 8) << shift;
+      }
+      out[x] = res;
+    }
+  }
+}
+
+PostProcess::PostProcess(int frame_width, int frame_height):
+  frame_width(frame_width), frame_height(frame_height), width(frame_width / 2), height(frame_height / 2),
+  input(new uint32_t[frame_width * frame_height]), glow(new uint32_t[width * height]),
+  column_shade(frame_width * 4), row_shade(frame_height)
+{
+  assert(frame_width % 2 == 0 && frame_height % 2 == 0);
+  // 1 in the middle down to 3/4 at the edges, both ways
+  auto vignette = [](int i, int n) {
+    float u = (i + 0.5f) / n * 2 - 1;
+    return 1 - u * u / 4;
+  };
+  for (int x = 0; x < frame_width; x++) {
+    uint16_t f = std::lround(vignette(x, frame_width) * 256);
+    for (int c = 0; c < 3; c++)
+      column_shade[4 * x + c] = f;
+    column_shade[4 * x + 3] = 256;
+  }
+  for (int y = 0; y < frame_height; y++)
+    row_shade[y] = std::lround(vignette(y, frame_height) * (y % 2 ? 0.8f : 1.0f) * 256);
+}
+
+void PostProcess::apply(const Surface &out) {
+  assert(out.width == frame_width && out.height == frame_height && !out.indices);
+  if (!enabled()) return;
+  int bands = (height + band - 1) / band;
+  // The second pass blurs across bands, so the first one has to finish
+  if (bloom) {
+    workers().parallelFor(bands, [&](int i) {
+      glowRows(i * band, std::min(height, (i + 1) * band));
+    });
+  }
+  workers().parallelFor(bands, [&](int i) {
+    finishRows(out, i * band, std::min(height, (i + 1) * band));
+  });
+}
+
+void PostProcess::glowRows(int y0, int y1) {
+  // Alpha is over any threshold, the glow has none
+  const uint32_t threshold = 0xff000000 | bloom_threshold * 0x010101u;
+  std::vector<uint32_t> bright(width + 2 * radius);
+  uint32_t *row = &bright[radius];
+  const uint32_t *src[taps];
+  for (int k = 0; k < taps; k++)
+    src[k] = &bright[k];
+
+  for (int y = y0; y < y1; y++) {
+    // Average of each 2x2 block, less the threshold
+    const uint32_t *a = frameRow(2 * y), *b = frameRow(2 * y + 1);
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i t = _mm_set1_epi32(threshold);
+    for (const int vec_end = width & ~3; x < vec_end; x += 4) {
+      __m128 v0 = _mm_castsi128_ps(_mm_avg_epu8(_mm_loadu_si128((const __m128i *)(a + 2 * x)),
+                                                _mm_loadu_si128((const __m128i *)(b + 2 * x))));
+      __m128 v1 = _mm_castsi128_ps(_mm_avg_epu8(_mm_loadu_si128((const __m128i *)(a + 2 * x + 4)),
+                                                _mm_loadu_si128((const __m128i *)(b + 2 * x + 4))));
+      __m128i even = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+      __m128i odd = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+      _mm_storeu_si128((__m128i *)(row + x), _mm_subs_epu8(_mm_avg_epu8(even, odd), t));
+    }
+#endif
+    for (; x < width; x++) {
+      uint32_t p = average(average(a[2 * x], b[2 * x]), average(a[2 * x + 1], b[2 * x + 1]));
+      row[x] = subtract(p, threshold);
+    }
+
+    std::fill(&bright[0], row, row[0]);
+    std::fill(row + width, row + width + radius, row[width - 1]);
+    blur(src, width, &glow[y * width]);
+  }
+}
+
+void PostProcess::finishRows(const Surface &out, int y0, int y1) {
+  std::vector<uint32_t> blurred(width);
+  for (int y = y0; y < y1; y++) {
+    if (bloom) {
+      const uint32_t *src[taps];
+      for (int k = 0; k < taps; k++)
+        src[k] = &glow[std::clamp(y + k - radius, 0, height - 1) * width];
+      blur(src, width, blurred.data());
+    }
+
+    for (int sy = 2 * y; sy < 2 * y + 2; sy++) {
+      const uint32_t *row = frameRow(sy);
+      uint32_t *dst = out.row(sy);
+      const uint16_t shade = row_shade[sy];
+      int x = 0;
+#ifdef __SSE2__
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i rows = _mm_setr_epi16(shade, shade, shade, 256, shade, shade, shade, 256);
+      for (; x + 4 <= frame_width; x += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(row + x));
+        if (bloom) {
+          __m128i g = _mm_loadl_epi64((const __m128i *)(&blurred[x / 2]));
+          p = _mm_adds_epu8(p, _mm_unpacklo_epi32(g, g));
+        }
+        if (crt) {
+          __m128i lo = _mm_unpacklo_epi8(p, zero), hi = _mm_unpackhi_epi8(p, zero);
+          lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_loadu_si128((const __m128i *)(&column_shade[4 * x]))), 8);
+          hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_loadu_si128((const __m128i *)(&column_shade[4 * x + 8]))), 8);
+          lo = _mm_srli_epi16(_mm_mullo_epi16(lo, rows), 8);
+          hi = _mm_srli_epi16(_mm_mullo_epi16(hi, rows), 8);
+          p = _mm_packus_epi16(lo, hi);
+        }
+        _mm_storeu_si128((__m128i *)(dst + x), p);
+      }
+#endif
+      for (; x < frame_width; x++) {
+        uint32_t p = row[x], res = 0;
+        for (int c = 0; c < 4; c++) {
+          uint32_t v = p >> (8 * c) & 0xff;
+          if (bloom)
+            v = std::min(v + (blurred[x / 2] >> (8 * c) & 0xff), 255u);
+          if (crt)
+            v = (v * column_shade[4 * x + c] >> 8) * (c == 3 ? 256 : shade) >> 8;
+          res |= v << (8 * c);
+        }
+        dst[x] = res;
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "display.h"
+
+namespace display {
+  // Full frame effects from a composited frame into the backbuffer, or a
+  // surface of the same size. They cost the same whatever was drawn. The
+  // frame is left alone, so it can be updated in place from one apply() to
+  // the next.
+  class PostProcess {
+  public:
+    // Glow around bright things like projectiles and the ship: what is over
+    // the threshold, blurred at half resolution and added back
+    bool bloom = false;
+    uint8_t bloom_threshold = 160;
+
+    // Darker odd rows and corners, like an old monitor
+    bool crt = false;
+
+    // Even sizes only
+    PostProcess(int frame_width = SCREEN_WIDTH, int frame_height = SCREEN_HEIGHT);
+
+    bool enabled() const { return bloom || crt; }
+
+    // Where to composite the frame while enabled
+    uint32_t *frameRow(int y) { return &input[y * frame_width]; }
+
+    void apply(const Surface &out = screen());
+
+  private:
+    static constexpr int band = 16; // half resolution rows per job, they stay in cache
+
+    // Bright part of the half resolution frame, blurred along rows
+    void glowRows(int y0, int y1);
+    // Blurs the glow along columns and adds it, then shades for the CRT look
+    void finishRows(const Surface &out, int y0, int y1);
+
+    int frame_width, frame_height;
+    int width, height; // half resolution
+    std::unique_ptr<uint32_t[]> input;
+    std::unique_ptr<uint32_t[]> glow;
+    std::vector<uint16_t> column_shade; // per channel, 256 is 1
+    std::vector<uint16_t> row_shade;
+  };
+}
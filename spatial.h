@@ -0,0 +1,338 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+
+#include "geometry.h"
+
+// Bounding volume hierarchy over circles living in a wrapped (toroidal) world
+// of the given size. Item centers are expected to be wrapped into [0, size).
+// Queries see every periodic image of the world, so things near one edge are
+// found from the opposite edge too.
+struct SpatialIndex {
+  struct Circle { Vec c; float r; };
+
+  struct Box {
+    Vec lo, hi;
+
+    static Box of(Circle c) { return {c.c - Vec{c.r, c.r}, c.c + Vec{c.r, c.r}}; }
+
+    Box merge(Box o) const {
+      return {{std::min(lo.x, o.lo.x), std::min(lo.y, o.lo.y)},
+              {std::max(hi.x, o.hi.x), std::max(hi.y, o.hi.y)}};
+    }
+
+    float area() const { return (hi.x - lo.x) * (hi.y - lo.y); }
+
+    float dist2(Vec p) const {
+      float dx = std::max({lo.x - p.x, 0.0f, p.x - hi.x});
+      float dy = std::max({lo.y - p.y, 0.0f, p.y - hi.y});
+      return dx * dx + dy * dy;
+    }
+  };
+
+  struct Node {
+    Box box;
+    int left, right;  // children, -1 for leaves
+    int first, count; // range in `order` for leaves
+  };
+
+  struct Hit {
+    int item = -1; // -1 if nothing was hit
+    float t = 0;   // distance along the ray
+    Vec point{0, 0};
+  };
+
+  static constexpr int leaf_size = 4;
+  // Median splits keep the depth logarithmic, this is plenty for any count
+  // that fits in memory
+  static constexpr int max_depth = 64;
+  // Refitting is cheap, but wrapping bodies and reused slots make boxes grow;
+  // once the leaves cover this much more area than right after the build,
+  // rebuild. The root always spans about the whole world, so it can't tell.
+  static constexpr float rebuild_ratio = 1.5f;
+
+  Vec size{0, 0};
+  std::vector<Circle> items;
+  std::vector<Node> nodes;
+  std::vector<int> order;
+  float built_area = 0; // summed leaf box area right after the build
+  float max_radius = 0;
+
+  int count() const { return items.size(); }
+
+  // Rebuilds the tree from scratch. `get(i)` must return the Circle of item i.
+  template <class Get>
+  void build(Vec world_size, int n, Get &&get) {
+    size = world_size;
+    items.resize(n);
+    for (int i = 0; i < n; i++)
+      items[i] = get(i);
+    order.resize(n);
+    for (int i = 0; i < n; i++)
+      order[i] = i;
+    nodes.clear();
+    if (n > 0)
+      buildNode(0, n);
+    updateMaxRadius();
+    built_area = leafArea();
+  }
+
+  // Keeps the tree topology and only recomputes boxes. Falls back to a full
+  // build when the item count changed or the tree got too loose.
+  template <class Get>
+  void update(Vec world_size, int n, Get &&get) {
+    if (n != count() || world_size.x != size.x || world_size.y != size.y) {
+      build(world_size, n, get);
+      return;
+    }
+    for (int i = 0; i < n; i++)
+      items[i] = get(i);
+    refit();
+    if (n > 0 && leafArea() > built_area * rebuild_ratio)
+      build(world_size, n, get);
+  }
+
+  void refit() {
+    // Children are always stored after their parent
+    for (int i = (int)nodes.size() - 1; i >= 0; i--) {
+      Node &node = nodes[i];
+      if (node.left < 0) {
+        node.box = leafBox(node.first, node.count);
+      } else {
+        node.box = nodes[node.left].box.merge(nodes[node.right].box);
+      }
+    }
+    updateMaxRadius();
+  }
+
+  // The items were reordered, perm[new_index] == old_index. Keeps the tree.
+  void remap(const std::vector<int> &perm) {
+    std::vector<int> moved_to(perm.size());
+    std::vector<Circle> remapped(perm.size());
+    for (size_t i = 0; i < perm.size(); i++) {
+      moved_to[perm[i]] = i;
+      remapped[i] = items[perm[i]];
+    }
+    items = std::move(remapped);
+    for (int &i : order)
+      i = moved_to[i];
+  }
+
+  // Calls fn(i) for every item whose circle touches the circle (p, r).
+  template <class Fn>
+  void queryRadius(Vec p, float r, Fn &&fn) const {
+    if (nodes.empty()) return;
+    forEachImage(p, r, [&](Vec q) {
+      int stack[max_depth], top = 0;
+      stack[top++] = 0;
+      while (top > 0) {
+        const Node &node = nodes[stack[--top]];
+        if (node.box.dist2(q) > r * r) continue;
+        if (node.left >= 0) {
+          stack[top++] = node.left;
+          stack[top++] = node.right;
+          continue;
+        }
+        for (int k = node.first; k < node.first + node.count; k++) {
+          const Circle &c = items[order[k]];
+          float rr = r + c.r;
+          Vec d = c.c - q;
+          if (d.x * d.x + d.y * d.y <= rr * rr)
+            fn(order[k]);
+        }
+      }
+    });
+  }
+
+  std::vector<int> queryRadius(Vec p, float r) const {
+    std::vector<int> res;
+    queryRadius(p, r, [&](int i) {
+      if (std::find(res.begin(), res.end(), i) == res.end())
+        res.push_back(i);
+    });
+    return res;
+  }
+
+  // Up to k items ordered by the gap between p and their circles (0 if p is
+  // inside). `accept(i)` filters out items that should not be considered.
+  template <class Accept>
+  std::vector<int> nearest(Vec p, int k, Accept &&accept) const {
+    std::vector<int> res;
+    if (nodes.empty() || k <= 0) return res;
+
+    struct Entry {
+      float d2;
+      int node; // -1 for items
+      int item;
+      Vec q;
+      bool operator<(const Entry &o) const { return d2 > o.d2; }
+    };
+    std::priority_queue<Entry> queue;
+
+    // Every image that could be closer than half the world
+    for (int ix = -1; ix <= 1; ix++)
+    for (int iy = -1; iy <= 1; iy++) {
+      Vec q = p - Vec{ix * size.x, iy * size.y};
+      queue.push({nodes[0].box.dist2(q), 0, -1, q});
+    }
+
+    while (!queue.empty() && (int)res.size() < k) {
+      Entry e = queue.top();
+      queue.pop();
+      if (e.node < 0) {
+        if (std::find(res.begin(), res.end(), e.item) == res.end())
+          res.push_back(e.item);
+        continue;
+      }
+      const Node &node = nodes[e.node];
+      if (node.left >= 0) {
+        queue.push({nodes[node.left].box.dist2(e.q), node.left, -1, e.q});
+        queue.push({nodes[node.right].box.dist2(e.q), node.right, -1, e.q});
+        continue;
+      }
+      for (int j = node.first; j < node.first + node.count; j++) {
+        int i = order[j];
+        if (!accept(i)) continue;
+        float gap = std::max(0.0f, (items[i].c - e.q).len() - items[i].r);
+        queue.push({gap * gap, -1, i, e.q});
+      }
+    }
+    return res;
+  }
+
+  std::vector<int> nearest(Vec p, int k) const {
+    return nearest(p, k, [](int) { return true; });
+  }
+
+  // First item hit by the segment from `from` along `dir` (normalized) no
+  // further than `max_dist`. The segment wraps around the world edges.
+  template <class Accept>
+  Hit raycast(Vec from, Vec dir, float max_dist, Accept &&accept) const {
+    Hit best;
+    if (nodes.empty()) return best;
+    best.t = max_dist;
+
+    Vec to = from + dir * max_dist;
+    Vec lo{std::min(from.x, to.x) - max_radius, std::min(from.y, to.y) - max_radius};
+    Vec hi{std::max(from.x, to.x) + max_radius, std::max(from.y, to.y) + max_radius};
+    int kx0 = std::floor(lo.x / size.x), kx1 = std::floor(hi.x / size.x);
+    int ky0 = std::floor(lo.y / size.y), ky1 = std::floor(hi.y / size.y);
+
+    Vec inv{dir.x ? 1 / dir.x : 0, dir.y ? 1 / dir.y : 0}; // unused for zero components
+    int stack[max_depth], top;
+    for (int kx = kx0; kx <= kx1; kx++)
+    for (int ky = ky0; ky <= ky1; ky++) {
+      Vec o = from - Vec{kx * size.x, ky * size.y};
+      stack[0] = 0, top = 1;
+      while (top > 0) {
+        const Node &node = nodes[stack[--top]];
+        if (!rayBox(o, dir, inv, best.t, node.box)) continue;
+        if (node.left >= 0) {
+          stack[top++] = node.left;
+          stack[top++] = node.right;
+          continue;
+        }
+        for (int j = node.first; j < node.first + node.count; j++) {
+          int i = order[j];
+          float t;
+          if (!rayCircle(o, dir, items[i], t) || t > best.t || !accept(i)) continue;
+          best = Hit{i, t, (from + dir * t).wrap(size)};
+        }
+      }
+    }
+    return best;
+  }
+
+  Hit raycast(Vec from, Vec dir, float max_dist) const {
+    return raycast(from, dir, max_dist, [](int) { return true; });
+  }
+
+private:
+  int buildNode(int first, int count) {
+    int id = nodes.size();
+    nodes.push_back(Node{leafBox(first, count), -1, -1, first, count});
+    if (count <= leaf_size)
+      return id;
+
+    Box centers{items[order[first]].c, items[order[first]].c};
+    for (int k = first; k < first + count; k++)
+      centers = centers.merge(Box{items[order[k]].c, items[order[k]].c});
+    bool by_x = centers.hi.x - centers.lo.x >= centers.hi.y - centers.lo.y;
+
+    int mid = first + count / 2;
+    std::nth_element(order.begin() + first, order.begin() + mid, order.begin() + first + count,
+      [&](int a, int b) { return by_x ? items[a].c.x < items[b].c.x : items[a].c.y < items[b].c.y; });
+
+    int left = buildNode(first, mid - first);
+    int right = buildNode(mid, first + count - mid);
+    nodes[id].left = left;
+    nodes[id].right = right;
+    return id;
+  }
+
+  Box leafBox(int first, int count) const {
+    Box box = Box::of(items[order[first]]);
+    for (int k = first + 1; k < first + count; k++)
+      box = box.merge(Box::of(items[order[k]]));
+    return box;
+  }
+
+  void updateMaxRadius() {
+    max_radius = 0;
+    for (const Circle &c : items)
+      max_radius = std::max(max_radius, c.r);
+  }
+
+  // Calls fn(q) for every translation q of p by a multiple of the world size
+  // such that the circle (q, r) may touch something inside the world.
+  template <class Fn>
+  void forEachImage(Vec p, float r, Fn &&fn) const {
+    float reach = r + max_radius;
+    for (int ix = -1; ix <= 1; ix++) {
+      float qx = p.x - ix * size.x;
+      if (qx + reach < 0 || qx - reach > size.x) continue;
+      for (int iy = -1; iy <= 1; iy++) {
+        float qy = p.y - iy * size.y;
+        if (qy + reach < 0 || qy - reach > size.y) continue;
+        fn(Vec{qx, qy});
+      }
+    }
+  }
+
+  float leafArea() const {
+    float res = 0;
+    for (const Node &node : nodes)
+      if (node.left < 0)
+        res += node.box.area();
+    return res;
+  }
+
+  static bool rayBox(Vec o, Vec dir, Vec inv, float max_t, const Box &box) {
+    float tmin = 0, tmax = max_t;
+    // A ray parallel to the slab is inside it or never gets there, 1 / 0
+    // would give 0 * inf = NaN for the first case
+    auto slab = [&](float o, float d, float inv, float lo, float hi) {
+      if (d == 0) return lo <= o && o <= hi;
+      float t0 = (lo - o) * inv, t1 = (hi - o) * inv;
+      tmin = std::max(tmin, std::min(t0, t1));
+      tmax = std::min(tmax, std::max(t0, t1));
+      return true;
+    };
+    return slab(o.x, dir.x, inv.x, box.lo.x, box.hi.x) &&
+           slab(o.y, dir.y, inv.y, box.lo.y, box.hi.y) && tmin <= tmax;
+  }
+
+  static bool rayCircle(Vec o, Vec dir, const Circle &c, float &t) {
+    Vec d = o - c.c;
+    float b = d.x * dir.x + d.y * dir.y;
+    float e = d.x * d.x + d.y * d.y - c.r * c.r;
+    if (e <= 0) { t = 0; return true; } // starts inside
+    float disc = b * b - e;
+    if (disc < 0 || b > 0) return false;
+    t = -b - std::sqrt(disc);
+    return true;
+  }
+};
@@ -0,0 +1,204 @@
+#include "tiles.h"
+
+#include <algorithm>
+
+namespace display {
+
+WorkerPool::WorkerPool(int threads) {
+  for (int i = 0; i < threads; i++)
+    workers.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  wake.notify_all();
+  for (std::thread &t : workers)
+    t.join();
+}
+
+void WorkerPool::work() {
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [&] { return quit || generation != seen; });
+    if (quit)
+      return;
+    seen = generation;
+    const std::function<void(int)> &fn = *job;
+    int n = job_size;
+
+    lock.unlock();
+    for (int i; (i = next++) < n;)
+      fn(i);
+    lock.lock();
+
+    if (--busy == 0)
+      done.notify_one();
+  }
+}
+
+void WorkerPool::parallelFor(int n, const std::function<void(int)> &fn) {
+  if (workers.empty() || n <= 1) {
+    for (int i = 0; i < n; i++)
+      fn(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &fn;
+    job_size = n;
+    next = 0;
+    busy = workers.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  for (int i; (i = next++) < n;)
+    fn(i);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return busy == 0; });
+  job = nullptr;
+}
+
+WorkerPool &workers() {
+  static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
+
+Rect TileRenderer::tileRect(int tile) {
+  int x = tile % tiles_x * tile_size, y = tile / tiles_x * tile_size;
+  return Rect{x, y, x + tile_size, y + tile_size}.intersect(screen_rect);
+}
+
+void TileRenderer::diff(const CommandBuffer &cmds, std::vector<Rect> &dirty) {
+  const std::vector<Command> &list = cmds.commands();
+  current.resize(list.size());
+  for (size_t i = 0; i < list.size(); i++)
+    current[i] = Drawn{cmds.hash(list[i]), list[i].bounds};
+
+  // Match equal commands between frames, by hash then by position
+  std::vector<std::pair<uint64_t, int>> before(last.size()), now(current.size());
+  for (size_t i = 0; i < last.size(); i++) before[i] = {last[i].hash, (int)i};
+  for (size_t i = 0; i < current.size(); i++) now[i] = {current[i].hash, (int)i};
+  std::sort(before.begin(), before.end());
+  std::sort(now.begin(), now.end());
+
+  std::vector<int> matched(current.size(), -1); // index in the last frame
+  size_t i = 0, j = 0;
+  while (i < before.size() || j < now.size()) {
+    if (j == now.size() || (i < before.size() && before[i].first < now[j].first)) {
+      dirty.push_back(last[before[i++].second].bounds); // gone
+    } else if (i == before.size() || now[j].first < before[i].first) {
+      dirty.push_back(current[now[j++].second].bounds); // new
+    } else {
+      matched[now[j++].second] = before[i++].second;
+    }
+  }
+
+  // Matched commands that changed their relative order may now cover each
+  // other differently. Keep the longest run that stayed in order, the rest
+  // counts as moved.
+  std::vector<int> tails, tail_at, prev(current.size(), -1);
+  for (int k = 0; k < (int)current.size(); k++) {
+    if (matched[k] < 0) continue;
+    auto pos = std::lower_bound(tails.begin(), tails.end(), matched[k]) - tails.begin();
+    if (pos > 0) prev[k] = tail_at[pos - 1];
+    if (pos == (int)tails.size()) {
+      tails.push_back(matched[k]);
+      tail_at.push_back(k);
+    } else {
+      tails[pos] = matched[k];
+      tail_at[pos] = k;
+    }
+  }
+  std::vector<bool> in_order(current.size(), false);
+  for (int k = tail_at.empty() ? -1 : tail_at.back(); k >= 0; k = prev[k])
+    in_order[k] = true;
+  for (int k = 0; k < (int)current.size(); k++)
+    if (matched[k] >= 0 && !in_order[k])
+      dirty.push_back(current[k].bounds);
+
+  std::swap(last, current);
+}
+
+void TileRenderer::render(const CommandBuffer &cmds, uint32_t background) {
+  dirty.clear();
+  if (!incremental || !valid || background != last_background) {
+    dirty.push_back(surface.bounds());
+    last.clear();
+    valid = true;
+    last_background = background;
+  }
+  diff(cmds, dirty);
+
+  // Bounding box of the damage within each tile
+  for (Rect &d : damage)
+    d = Rect{SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0};
+  for (const Rect &d : dirty) {
+    Rect r = d.intersect(surface.bounds());
+    if (r.empty()) continue;
+    for (int ty = r.y0 / tile_size; ty <= (r.y1 - 1) / tile_size; ty++)
+    for (int tx = r.x0 / tile_size; tx <= (r.x1 - 1) / tile_size; tx++) {
+      Rect &t = damage[ty * tiles_x + tx];
+      Rect part = r.intersect(tileRect(ty * tiles_x + tx));
+      t = Rect{std::min(t.x0, part.x0), std::min(t.y0, part.y0), std::max(t.x1, part.x1), std::max(t.y1, part.y1)};
+    }
+  }
+
+  const std::vector<Command> &list = cmds.commands();
+  for (bool &t : translucent)
+    t = (background >> 24) != 255 && (background >> 24) != 0;
+  for (int i = 0; i < (int)list.size(); i++) {
+    Rect r = list[i].bounds.intersect(surface.bounds());
+    if (r.empty()) continue;
+    bool blends = list[i].translucent();
+    for (int ty = r.y0 / tile_size; ty <= (r.y1 - 1) / tile_size; ty++)
+    for (int tx = r.x0 / tile_size; tx <= (r.x1 - 1) / tile_size; tx++) {
+      int tile = ty * tiles_x + tx;
+      translucent[tile] |= blends;
+      if (!damage[tile].empty())
+        bins[tile].push_back(i);
+    }
+  }
+
+  workers().parallelFor(tiles_x * tiles_y, [&](int tile) {
+    Rect r = damage[tile];
+    if (r.empty()) return;
+    Surface s = surface.clipped(r);
+
+    if (front_to_back) {
+      Rect t = tileRect(tile);
+      Coverage cover{t.x0, t.y0, {}};
+      s.coverage = &cover;
+      const std::vector<int> &bin = bins[tile];
+      int back = bin.size(); // [0, back) goes back to front
+      while (back > 0 && !list[bin[back - 1]].translucent()) back--;
+
+      for (int k = (int)bin.size() - 1; k >= back; k--)
+        cmds.execute(list[bin[k]], s);
+      cover.marks = false;
+      for (int y = r.y0; y < r.y1; y++) {
+        forUncovered(s, y, r.x0, r.x1, [&](int from, int to) {
+          fillPixels(s, y, from, to, background);
+        });
+      }
+      for (int k = 0; k < back; k++)
+        cmds.execute(list[bin[k]], s);
+    } else {
+      for (int y = r.y0; y < r.y1; y++)
+        fillPixels(s, y, r.x0, r.x1, background);
+      for (int i : bins[tile])
+        cmds.execute(list[i], s);
+    }
+  });
+
+  for (auto &bin : bins)
+    bin.clear();
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "display.h"
+#include "commands.h"
+
+namespace display {
+  // Fixed set of threads that split loops between themselves and the caller
+  class WorkerPool {
+  public:
+    // Extra threads besides the calling one
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    // Calls fn(i) for every i in [0, n), returns once all calls are done
+    void parallelFor(int n, const std::function<void(int)> &fn);
+
+    int threads() const { return workers.size() + 1; }
+
+  private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)> *job = nullptr;
+    int job_size = 0;
+    std::atomic<int> next{0};
+    int busy = 0; // workers that did not finish the current job yet
+    uint64_t generation = 0;
+    bool quit = false;
+  };
+
+  // One worker per core, shared by all renderers
+  WorkerPool &workers();
+
+  // Bins recorded commands by screen tile and draws the frame tile by tile,
+  // tiles in parallel. Commands touching a tile run in recording order, with
+  // the surface clipped to the tile.
+  class TileRenderer {
+  public:
+    static constexpr int tile_size = Coverage::size;
+    static constexpr int tiles_x = (SCREEN_WIDTH + tile_size - 1) / tile_size;
+    static constexpr int tiles_y = (SCREEN_HEIGHT + tile_size - 1) / tile_size;
+
+    // Only redraw where this frame differs from the previous one. Needs the
+    // surface to keep what render() left there.
+    bool incremental = true;
+
+    // Where the frame is drawn, at most screen sized. Call invalidate()
+    // after pointing it somewhere else.
+    Surface surface = screen();
+
+    // Draw each tile's commands last to first, skipping pixels something in
+    // front already covered, then fill what is left with the background.
+    // Every pixel is written once, however much overlaps. Translucent
+    // commands need what is behind them first, so from the last of them
+    // down everything is drawn in order, still skipping covered pixels.
+    bool front_to_back = false;
+
+    // Clears to `background` and draws the commands. Incrementally, only
+    // parts covered by commands that appeared, disappeared or changed their
+    // order since the last frame are touched.
+    void render(const CommandBuffer &cmds, uint32_t background);
+
+    // Something else drew into the surface, redraw everything next time
+    void invalidate() { valid = false; }
+
+    // Part of the tile the last render() changed, empty if none
+    Rect tileDamage(int tile) const { return damage[tile]; }
+
+    // Some pixel of the tile may be translucent after the last render()
+    bool tileTranslucent(int tile) const { return translucent[tile]; }
+
+    static Rect tileRect(int tile);
+
+  private:
+    struct Drawn {
+      uint64_t hash;
+      Rect bounds;
+    };
+
+    // Parts of the screen that change this frame, appends to `dirty`
+    void diff(const CommandBuffer &cmds, std::vector<Rect> &dirty);
+
+    std::vector<int> bins[tiles_x * tiles_y];
+    Rect damage[tiles_x * tiles_y];
+    bool translucent[tiles_x * tiles_y] = {};
+    std::vector<Drawn> last, current;
+    std::vector<Rect> dirty;
+    uint32_t last_background = 0;
+    bool valid = false;
+  };
+}